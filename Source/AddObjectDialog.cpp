@@ -65,7 +65,7 @@ public:
         }
 
         // Remove from scene
-        mTab->GetScene().removeItem(mNewItem);
+        mTab->GetScene().RemoveItem(mNewItem);
         mAdded = false;
 
         mSelectionSaver.undo();
@@ -77,7 +77,7 @@ public:
         mCamera->mMapObjects.emplace_back(std::unique_ptr<MapObject>(mNewItem->GetMapObject()));
 
         // Add to scene
-        mTab->GetScene().addItem(mNewItem);
+        mTab->GetScene().AddItem(mNewItem);
 
         // Set the new item as the only thing selected
         mTab->GetScene().clearSelection();
@@ -3,8 +3,8 @@
 #include "IGraphicsItem.hpp"
 #include <QDateTime>
 
-ChangeBasicTypePropertyCommand::ChangeBasicTypePropertyCommand(LinkedProperty linkedProperty, BasicTypePropertyChangeData propertyData) 
-    : mLinkedProperty(linkedProperty), mPropertyData(propertyData)
+ChangeBasicTypePropertyCommand::ChangeBasicTypePropertyCommand(std::vector<LinkedProperty> linkedProperties, BasicTypePropertyChangeData propertyData) 
+    : mLinkedProperties(std::move(linkedProperties)), mPropertyData(std::move(propertyData))
 {
     UpdateText();
     mTimeStamp = QDateTime::currentMSecsSinceEpoch();
@@ -12,16 +12,40 @@ ChangeBasicTypePropertyCommand::ChangeBasicTypePropertyCommand(LinkedProperty li
 
 void ChangeBasicTypePropertyCommand::undo()
 {
-    mLinkedProperty.mProperty->mBasicTypeValue = mPropertyData.mOldValue;
-    mLinkedProperty.mTreeWidget->FindObjectPropertyByKey(mLinkedProperty.mProperty)->Refresh();
-    mLinkedProperty.mGraphicsItem->SyncInternalObject();
+    for (size_t i = 0; i < mLinkedProperties.size(); i++)
+    {
+        LinkedProperty& linkedProperty = mLinkedProperties[i];
+        linkedProperty.mProperty->mBasicTypeValue = mPropertyData.mOldValues[i];
+        linkedProperty.mTreeWidget->RefreshProperty(linkedProperty.mProperty);
+        linkedProperty.mGraphicsItem->SyncInternalObject();
+    }
 }
 
 void ChangeBasicTypePropertyCommand::redo()
 {
-    mLinkedProperty.mProperty->mBasicTypeValue = mPropertyData.mNewValue;
-    mLinkedProperty.mTreeWidget->FindObjectPropertyByKey(mLinkedProperty.mProperty)->Refresh();
-    mLinkedProperty.mGraphicsItem->SyncInternalObject();
+    for (LinkedProperty& linkedProperty : mLinkedProperties)
+    {
+        linkedProperty.mProperty->mBasicTypeValue = mPropertyData.mNewValue;
+        linkedProperty.mTreeWidget->RefreshProperty(linkedProperty.mProperty);
+        linkedProperty.mGraphicsItem->SyncInternalObject();
+    }
+}
+
+static bool SameProperties(const std::vector<LinkedProperty>& a, const std::vector<LinkedProperty>& b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i].mProperty != b[i].mProperty)
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool ChangeBasicTypePropertyCommand::mergeWith(const QUndoCommand* command)
@@ -29,7 +53,7 @@ bool ChangeBasicTypePropertyCommand::mergeWith(const QUndoCommand* command)
     if (command->id() == id())
     {
         auto pOther = static_cast<const ChangeBasicTypePropertyCommand*>(command);
-        if (mLinkedProperty.mProperty == pOther->mLinkedProperty.mProperty)
+        if (SameProperties(mLinkedProperties, pOther->mLinkedProperties))
         {
             // Compare time stamps and only merge if dt <= 1 second
             if (abs(mTimeStamp - pOther->mTimeStamp) <= 1000)
@@ -46,53 +70,13 @@ bool ChangeBasicTypePropertyCommand::mergeWith(const QUndoCommand* command)
 
 void ChangeBasicTypePropertyCommand::UpdateText()
 {
-    setText(QString("Change property %1 from %2 to %3").arg(mLinkedProperty.mProperty->mName.c_str(), QString::number(mPropertyData.mOldValue), QString::number(mPropertyData.mNewValue)));
-}
-
-BasicTypeProperty::BasicTypeProperty(QUndoStack& undoStack, QTreeWidgetItem* pParent, QString propertyName, ObjectProperty* pProperty, IGraphicsItem* pGraphicsItem, BasicType* pBasicType) : PropertyTreeItemBase(pParent, QStringList{ propertyName, QString::number(pProperty->mBasicTypeValue) }), mUndoStack(undoStack), mProperty(pProperty), mBasicType(pBasicType), mGraphicsItem(pGraphicsItem)
-{
-
-}
-
-QWidget* BasicTypeProperty::CreateEditorWidget(PropertyTreeWidget* pParent)
-{
-    mSpinBox = new BigSpinBox(pParent);
-    mSpinBox->setMax(mBasicType->mMaxValue);
-    mSpinBox->setMin(mBasicType->mMinValue);
-    mSpinBox->setValue(mProperty->mBasicTypeValue);
-
-    mOldValue = mProperty->mBasicTypeValue;
-
-    connect(mSpinBox, &BigSpinBox::valueChanged, this, [pParent, this](qint64 newValue, bool closeEditor)
-        {
-            if (mOldValue != newValue)
-            {
-                mUndoStack.push(new ChangeBasicTypePropertyCommand(
-                    LinkedProperty(pParent, this->mProperty, this->mGraphicsItem),
-                    BasicTypePropertyChangeData(this->mBasicType, this->mOldValue, newValue)));
-            }
-            mOldValue = newValue;
-
-            if (closeEditor)
-            {
-                pParent->setItemWidget(this, 1, nullptr);
-            }
-        });
-
-    connect(mSpinBox, &BigSpinBox::destroyed, this, [this](QObject*)
-        {
-            this->mSpinBox = nullptr;
-        });
-
-    return mSpinBox;
-}
-
-void BasicTypeProperty::Refresh()
-{
-    setText(1, QString::number(mProperty->mBasicTypeValue));
-
-    if (mSpinBox)
+    const LinkedProperty& first = mLinkedProperties[0];
+    if (mLinkedProperties.size() == 1)
+    {
+        setText(QString("Change property %1 from %2 to %3").arg(first.mProperty->mName.c_str(), QString::number(mPropertyData.mOldValues[0]), QString::number(mPropertyData.mNewValue)));
+    }
+    else
     {
-        mSpinBox->setValue(mProperty->mBasicTypeValue, false);
+        setText(QString("Change property %1 of %2 objects to %3").arg(first.mProperty->mName.c_str(), QString::number(mLinkedProperties.size()), QString::number(mPropertyData.mNewValue)));
     }
 }
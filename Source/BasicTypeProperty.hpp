@@ -1,28 +1,31 @@
 #pragma once
 
-#include "PropertyTreeItemBase.hpp"
+#include "PropertyTreeWidget.hpp"
 #include <QUndoCommand>
+#include <vector>
 
 struct BasicType;
 class QUndoStack;
-class BigSpinBox;
 
 struct BasicTypePropertyChangeData
 {
-    BasicTypePropertyChangeData(BasicType* pBasicType, int oldValue, int newValue)
-        : mBasicType(pBasicType), mOldValue(oldValue), mNewValue(newValue)
+    BasicTypePropertyChangeData(BasicType* pBasicType, std::vector<int> oldValues, int newValue)
+        : mBasicType(pBasicType), mOldValues(std::move(oldValues)), mNewValue(newValue)
     {
 
     }
     BasicType* mBasicType = nullptr;
-    int mOldValue = 0;
+
+    // One per linked property
+    std::vector<int> mOldValues;
     int mNewValue = 0;
 };
 
+// Sets the property of every selected object at once, each item is synced once per undo or redo
 class ChangeBasicTypePropertyCommand final : public QUndoCommand
 {
 public:
-    ChangeBasicTypePropertyCommand(LinkedProperty linkedProperty, BasicTypePropertyChangeData propertyData);
+    ChangeBasicTypePropertyCommand(std::vector<LinkedProperty> linkedProperties, BasicTypePropertyChangeData propertyData);
 
     void undo() override;
 
@@ -37,31 +40,7 @@ public:
 
 private:
     void UpdateText();
-    LinkedProperty mLinkedProperty;
+    std::vector<LinkedProperty> mLinkedProperties;
     BasicTypePropertyChangeData mPropertyData;
     qint64 mTimeStamp = 0;
 };
-
-class BasicTypeProperty final : public QObject, public PropertyTreeItemBase
-{
-    Q_OBJECT
-public:
-    BasicTypeProperty(QUndoStack& undoStack, QTreeWidgetItem* pParent, QString propertyName, ObjectProperty* pProperty, IGraphicsItem* pGraphicsItem, BasicType* pBasicType);
-
-    QWidget* CreateEditorWidget(PropertyTreeWidget* pParent) override;
-
-    const void* GetPropertyLookUpKey() const override
-    {
-        return mProperty;
-    }
-
-    void Refresh() override;
-
-private:
-    QUndoStack& mUndoStack;
-    ObjectProperty* mProperty = nullptr;
-    IGraphicsItem* mGraphicsItem = nullptr;
-    BasicType* mBasicType = nullptr;
-    int mOldValue = 0;
-    BigSpinBox* mSpinBox = nullptr;
-};
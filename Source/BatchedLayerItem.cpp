@@ -0,0 +1,260 @@
+#include "BatchedLayerItem.hpp"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include "ResizeableArrowItem.hpp"
+#include "ResizeableRectItem.hpp"
+#include "Model.hpp"
+#include "EditorGraphicsScene.hpp"
+#include "PaintProfiler.hpp"
+#include "ObjectIconAtlas.hpp"
+
+BatchedLayerItem::BatchedLayerItem(Kind kind)
+    : mKind(kind)
+{
+    // Only here to be looked at, the real items get all the input
+    setAcceptedMouseButtons(Qt::NoButton);
+    setAcceptHoverEvents(false);
+    setFlag(ItemUsesExtendedStyleOption);
+
+    // Same depth as the items it draws, but as it's added first the real items are drawn over it
+    setZValue(kind == Kind::CollisionLines ? 2.0 : 3.0);
+}
+
+void BatchedLayerItem::Rebuild(const QList<QGraphicsItem*>& items)
+{
+    prepareGeometryChange();
+
+    mLines.clear();
+    mRects.clear();
+    mBoundingRect = QRectF();
+
+    for (QGraphicsItem* pItem : items)
+    {
+        UpdateItem(pItem);
+    }
+
+    update();
+}
+
+void BatchedLayerItem::AddBounds(const QRectF& bounds)
+{
+    if (!mBoundingRect.contains(bounds))
+    {
+        prepareGeometryChange();
+        mBoundingRect |= bounds;
+    }
+}
+
+void BatchedLayerItem::UpdateItem(QGraphicsItem* pItem)
+{
+    if (pItem->isSelected())
+    {
+        RemoveItem(pItem);
+        return;
+    }
+
+    if (mKind == Kind::CollisionLines)
+    {
+        auto pArrow = qgraphicsitem_cast<ResizeableArrowItem*>(pItem);
+        if (!pArrow)
+        {
+            return;
+        }
+
+        Line& entry = mLines[pItem];
+        const QRectF oldBounds = entry.mBounds;
+
+        entry.mColor = pArrow->Brush().color();
+        entry.mLines[0] = pArrow->line().translated(pArrow->pos());
+        ResizeableArrowItem::CalcArrowHead(entry.mLines[0], entry.mLines[1], entry.mLines[2]);
+        entry.mBounds = QRectF(entry.mLines[0].p1(), entry.mLines[0].p2()).normalized().adjusted(-10, -10, 10, 10);
+
+        AddBounds(entry.mBounds);
+        update(oldBounds | entry.mBounds);
+    }
+    else
+    {
+        auto pRect = qgraphicsitem_cast<ResizeableRectItem*>(pItem);
+        if (!pRect)
+        {
+            return;
+        }
+
+        Rect& entry = mRects[pItem];
+        const QRectF oldBounds = entry.mRect.isNull() ? QRectF() : entry.mRect.adjusted(-1, -1, 1, 1);
+
+        entry.mRect = pRect->CurrentRect();
+        entry.mIconRect = pRect->IconRect();
+        entry.mName = pRect->GetMapObject()->mObjectStructureType;
+        entry.mZ = pRect->zValue();
+
+        const QRectF bounds = entry.mRect.adjusted(-1, -1, 1, 1);
+        AddBounds(bounds);
+        update(oldBounds | bounds);
+    }
+}
+
+void BatchedLayerItem::RemoveItem(QGraphicsItem* pItem)
+{
+    auto lineIt = mLines.find(pItem);
+    if (lineIt != mLines.end())
+    {
+        update(lineIt->mBounds);
+        mLines.erase(lineIt);
+    }
+
+    auto rectIt = mRects.find(pItem);
+    if (rectIt != mRects.end())
+    {
+        update(rectIt->mRect.adjusted(-1, -1, 1, 1));
+        mRects.erase(rectIt);
+    }
+}
+
+QRectF BatchedLayerItem::boundingRect() const
+{
+    return mBoundingRect;
+}
+
+void BatchedLayerItem::paint(QPainter* aPainter, const QStyleOptionGraphicsItem* aOption, QWidget* /*aWidget*/)
+{
+    PAINT_PROFILE_SCOPE(BatchedLayer);
+
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (!pScene)
+    {
+        return;
+    }
+
+    // The layer items are at the origin so item and scene coordinates are the same. Grown by the
+    // same margin as the arrow bounds, an arrow head can reach a little past the item's own bounds.
+    const QRectF& exposed = aOption->exposedRect;
+    const QList<QGraphicsItem*> candidates = pScene->CollisionsAndMapObjectsIn(exposed.adjusted(-10, -10, 10, 10));
+    if (mKind == Kind::CollisionLines)
+    {
+        PaintLines(aPainter, candidates, exposed);
+    }
+    else
+    {
+        PaintRects(aPainter, candidates, exposed, aOption->levelOfDetailFromTransform(aPainter->worldTransform()));
+    }
+}
+
+void BatchedLayerItem::PaintLines(QPainter* aPainter, const QList<QGraphicsItem*>& candidates, const QRectF& exposed)
+{
+    // Grouped by the colour of their collision type so each colour is one drawLines call
+    struct LineGroup final
+    {
+        QColor mColor;
+        std::vector<QLineF> mLines;
+    };
+    std::vector<LineGroup> groups;
+
+    for (QGraphicsItem* pItem : candidates)
+    {
+        auto it = mLines.constFind(pItem);
+        if (it == mLines.constEnd() || !it->mBounds.intersects(exposed))
+        {
+            continue;
+        }
+
+        auto groupIt = std::find_if(groups.begin(), groups.end(), [&](const LineGroup& group) { return group.mColor == it->mColor; });
+        if (groupIt == groups.end())
+        {
+            groups.push_back(LineGroup{ it->mColor, {} });
+            groupIt = groups.end() - 1;
+        }
+        groupIt->mLines.insert(groupIt->mLines.end(), std::begin(it->mLines), std::end(it->mLines));
+    }
+
+    // Black outline under everything first, the same look as the stroked path of a single arrow
+    QPen outline(Qt::black, 6, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
+    aPainter->setPen(outline);
+    for (const auto& group : groups)
+    {
+        aPainter->drawLines(group.mLines.data(), static_cast<int>(group.mLines.size()));
+    }
+
+    for (const auto& group : groups)
+    {
+        aPainter->setPen(QPen(group.mColor, 3, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+        aPainter->drawLines(group.mLines.data(), static_cast<int>(group.mLines.size()));
+    }
+}
+
+void BatchedLayerItem::PaintRects(QPainter* aPainter, const QList<QGraphicsItem*>& candidates, const QRectF& exposed, qreal lod)
+{
+    std::vector<const Rect*> visible;
+    for (QGraphicsItem* pItem : candidates)
+    {
+        auto it = mRects.constFind(pItem);
+        if (it != mRects.constEnd() && it->mRect.intersects(exposed))
+        {
+            visible.push_back(&it.value());
+        }
+    }
+
+    // Back to front like the real items, ties are broken by position so the order doesn't change between paints
+    std::sort(visible.begin(), visible.end(), [](const Rect* a, const Rect* b)
+    {
+        if (a->mZ != b->mZ)
+        {
+            return a->mZ < b->mZ;
+        }
+        return std::make_pair(a->mRect.y(), a->mRect.x()) < std::make_pair(b->mRect.y(), b->mRect.x());
+    });
+
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    const bool drawNames = !pScene->DraftRendering();
+
+    // Objects with and without an icon are drawn differently, each run of the same kind in z order
+    // is drawn together so overlapping objects still cover each other the right way round
+    std::vector<QRectF> runRects;
+    std::vector<QPainter::PixmapFragment> iconFragments;
+    size_t runStart = 0;
+    while (runStart < visible.size())
+    {
+        const bool icons = !visible[runStart]->mIconRect.isNull();
+        size_t runEnd = runStart;
+        runRects.clear();
+        iconFragments.clear();
+        for (; runEnd < visible.size() && !visible[runEnd]->mIconRect.isNull() == icons; runEnd++)
+        {
+            const Rect* pRect = visible[runEnd];
+            runRects.push_back(pRect->mRect);
+            if (icons)
+            {
+                const QRectF source(pRect->mIconRect);
+                iconFragments.push_back(QPainter::PixmapFragment::create(pRect->mRect.center(), source,
+                    pRect->mRect.width() / source.width(), pRect->mRect.height() / source.height()));
+            }
+        }
+
+        aPainter->setPen(QPen(Qt::black, 2, Qt::SolidLine));
+        if (icons)
+        {
+            // All the icons come from the one atlas pixmap so they can be drawn in one call
+            aPainter->drawPixmapFragments(iconFragments.data(), static_cast<int>(iconFragments.size()), ObjectIconAtlas::Instance().Pixmap());
+            aPainter->setBrush(Qt::NoBrush);
+            aPainter->drawRects(runRects.data(), static_cast<int>(runRects.size()));
+        }
+        else
+        {
+            aPainter->setBrush(Qt::darkGray);
+            aPainter->drawRects(runRects.data(), static_cast<int>(runRects.size()));
+
+            if (drawNames)
+            {
+                for (size_t i = runStart; i < runEnd; i++)
+                {
+                    const Rect* pRect = visible[i];
+                    aPainter->translate(pRect->mRect.topLeft());
+                    DrawObjectName(aPainter, lod, pRect->mName, static_cast<int>(pRect->mRect.width()), static_cast<int>(pRect->mRect.height()));
+                    aPainter->translate(-pRect->mRect.topLeft());
+                }
+            }
+        }
+        runStart = runEnd;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QGraphicsItem>
+#include <QRect>
+#include <QHash>
+#include <QColor>
+#include <QLineF>
+#include <string>
+#include <vector>
+
+// Draws all of the collision lines or all of the map objects that aren't selected with a few draw
+// calls per paint. The real items stay in the scene for picking and editing but only draw
+// themselves while they are selected or hovered.
+class BatchedLayerItem final : public QGraphicsItem
+{
+public:
+    enum class Kind
+    {
+        CollisionLines,
+        MapObjects,
+    };
+
+    explicit BatchedLayerItem(Kind kind);
+
+    enum { Type = UserType + 3 };
+    int type() const override { return Type; }
+
+    Kind GetKind() const { return mKind; }
+
+    // Takes a copy of the geometry of every item of this layers kind that isn't selected
+    void Rebuild(const QList<QGraphicsItem*>& items);
+
+    // Copies the geometry of one item again, or stops drawing it once it's selected
+    void UpdateItem(QGraphicsItem* pItem);
+    void RemoveItem(QGraphicsItem* pItem);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* aPainter, const QStyleOptionGraphicsItem* aOption, QWidget* aWidget = nullptr) override;
+
+private:
+    void PaintLines(QPainter* aPainter, const QList<QGraphicsItem*>& candidates, const QRectF& exposed);
+    void PaintRects(QPainter* aPainter, const QList<QGraphicsItem*>& candidates, const QRectF& exposed, qreal lod);
+    void AddBounds(const QRectF& bounds);
+
+    struct Line final
+    {
+        QColor mColor;
+
+        // The line then the 2 sides of the head
+        QLineF mLines[3];
+
+        // Big enough for the pen and the arrow head
+        QRectF mBounds;
+    };
+
+    struct Rect final
+    {
+        QRectF mRect;
+
+        // In the ObjectIconAtlas
+        QRect mIconRect;
+        std::string mName;
+
+        // Overlapping objects are drawn in the same order as the real items would be
+        qreal mZ = 0;
+    };
+
+    Kind mKind;
+
+    // Only ever grows until the next full rebuild, shrinking it would mean looking at every item
+    QRectF mBoundingRect;
+
+    // Keyed by the real item so a moved item only replaces its own entry. Painting looks up the
+    // exposed items in the scene's spatial index rather than walking all of these.
+    QHash<QGraphicsItem*, Line> mLines;
+    QHash<QGraphicsItem*, Rect> mRects;
+};
@@ -52,10 +52,12 @@ void BigSpinBox::setValue( qint64 aValue, bool aEmitChangedSignal )
         aValue = mMinRange;
     }
 
-    if ( aValue != mValue )
+    if ( aValue != mValue || mMixed )
     {
         mValue = aValue;
         mOldValue = mValue;
+        mMixed = false;
+        mTypedOverMixed = false;
         updateLineEdit();
         if ( aEmitChangedSignal )
         {
@@ -64,17 +66,40 @@ void BigSpinBox::setValue( qint64 aValue, bool aEmitChangedSignal )
     }
 }
 
+void BigSpinBox::setMixed()
+{
+    mMixed = true;
+    mTypedOverMixed = false;
+    QLineEdit * const edit = lineEdit();
+    if ( edit )
+    {
+        edit->clear();
+    }
+}
+
+bool BigSpinBox::isMixed() const
+{
+    return mMixed;
+}
+
 void BigSpinBox::OnEditComplete()
 {
-    if ( mOldValue != mValue )
+    // Whatever number replaced the mixed values is a change, even if it happens to be mValue
+    if ( mOldValue != mValue || mTypedOverMixed )
     {
         mOldValue = mValue;
+        mTypedOverMixed = false;
         emit valueChanged( mValue, true );
     }
 }
 
 void BigSpinBox::stepBy( int aSteps )
 {
+    if ( mMixed )
+    {
+        return;
+    }
+
     qint64 temp = mValue;
     temp += aSteps;
     if ( temp > mMaxRange )
@@ -105,6 +130,12 @@ QValidator::State BigSpinBox::validate( QString& aInput, int& aPos ) const
 {
     bool ok = false;
     qint64 value = aInput.toLongLong( &ok );
+    if ( mMixed && !ok && ( aInput.isEmpty() || aInput == "-" ) )
+    {
+        // Still mixed, unlike below an empty box doesn't mean the min range here
+        return QValidator::Acceptable;
+    }
+
     if (!ok && aInput.isEmpty() || (aInput == "-" && mMinRange < 0))
     {
         // Special case to allow deleting all of the spinbox input, when deleted we use a value of the min range
@@ -125,6 +156,12 @@ QValidator::State BigSpinBox::validate( QString& aInput, int& aPos ) const
             return QValidator::Invalid;
         }
 
+        if ( mMixed )
+        {
+            mMixed = false;
+            mTypedOverMixed = true;
+        }
+
         if ( mValue != value )
         {
             mOldValue = mValue;
@@ -137,7 +174,11 @@ QValidator::State BigSpinBox::validate( QString& aInput, int& aPos ) const
 
 QAbstractSpinBox::StepEnabled BigSpinBox::stepEnabled() const
 {
-    // StepNone
+    // Stepping from a value that is only one of the mixed ones would set them all to it
+    if ( mMixed )
+    {
+        return StepNone;
+    }
     return StepUpEnabled | StepDownEnabled;
 }
 
@@ -13,6 +13,11 @@ public:
     void setRange( qint64 aMin, qint64 aMax );
     qint64 value() const;
     void setValue( qint64 aValue, bool aEmitChangedSignal = true );
+
+    // For several values that differ: shows nothing and ignores the arrows until a number is
+    // typed, so value() means nothing while isMixed() is true
+    void setMixed();
+    bool isMixed() const;
 signals:
     void valueChanged( qint64 aValue, bool closeEditor ) const;
 private slots:
@@ -27,6 +32,8 @@ private:
 private:
     mutable qint64 mValue = 0;
     mutable qint64 mOldValue = 0;
+    mutable bool mMixed = false;
+    mutable bool mTypedOverMixed = false;
     qint64 mMinRange = 0;
     qint64 mMaxRange = 0;
 };
@@ -1,44 +1,100 @@
 #include "CameraGraphicsItem.hpp"
 #include <QPen>
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QThreadPool>
+#include <QCoreApplication>
 #include "Model.hpp"
-#include "IGraphicsItem.hpp"
+#include "EditorGraphicsScene.hpp"
+#include "PaintProfiler.hpp"
 
-CameraGraphicsItem::CameraGraphicsItem(Camera* pCamera, int xpos, int ypos, int width, int height, int transparency) : QGraphicsRectItem(xpos, ypos, width, height), mCamera(pCamera)
+// No point going smaller than this, it's only a few pixels on screen by then
+static const int kMinMipWidth = 16;
+
+// An unloaded camera keeps a copy at least this wide, enough for the minimap and very zoomed out views
+static const int kThumbnailWidth = 64;
+
+static QImage DecodeBase64Image(const std::string& base64)
+{
+    QImage image;
+    image.loadFromData(QByteArray::fromBase64(QByteArray(base64.c_str(), static_cast<int>(base64.length()))));
+    return image;
+}
+
+static qint64 PixmapBytes(const QPixmap& pixmap)
+{
+    return static_cast<qint64>(pixmap.width()) * pixmap.height() * (pixmap.depth() / 8);
+}
+
+CameraGraphicsItem::CameraGraphicsItem(Camera* pCamera, int xpos, int ypos, int width, int height) : QGraphicsRectItem(xpos, ypos, width, height), mCamera(pCamera)
 {
     QPen pen;
     pen.setWidth(2);
     pen.setColor(QColor::fromRgb(120, 120, 120));
     setPen(pen);
     setZValue(1.0);
-    LoadImages();
-    IGraphicsItem::SetTransparency(this, transparency);
+
+    mDisplayedImage = std::make_shared<DisplayedImage>();
+    mDisplayedImage->mItem = this;
 }
 
 void CameraGraphicsItem::paint(QPainter* aPainter, const QStyleOptionGraphicsItem* aOption, QWidget* aWidget)
 {
-    // Draw the camera image if we have one
-    if (!mImages.mCamera.isNull())
+    PAINT_PROFILE_SCOPE(Camera);
+
+    // Account for AOs whacky camera offset, should probably be part of the json schema
+    int offX = 0;
+    int offY = 0;
+    if (rect().width() >= 1024)
+    {
+        offX = 258;
+        offY = 114;
+    }
+
+    QRect camImgRect = QRect(rect().x() + offX, rect().y() + offY, 368, 240);
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(aPainter->worldTransform());
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+
+    if (pScene && pScene->MinimapRendering())
     {
-        // Account for AOs whacky camera offset, should probably be part of the json schema
-        int offX = 0;
-        int offY = 0;
-        if (rect().width() >= 1024)
+        // Whatever is already decoded, the minimap renders every camera and mustn't decode them all
+        if (mImageLoaded && !mImages.mCamera.isNull())
         {
-            offX = 258;
-            offY = 114;
+            aPainter->drawPixmap(camImgRect, CameraPixmapForDrawnWidth(camImgRect.width() * lod));
+        }
+        else if (!mThumbnail.isNull())
+        {
+            aPainter->drawPixmap(camImgRect, mThumbnail);
+        }
+        else if (mCamera && !mCamera->mCameraImageandLayers.mCameraImage.empty())
+        {
+            aPainter->fillRect(camImgRect, QColor::fromRgb(90, 90, 90));
+        }
+    }
+    else if (!mImageLoaded)
+    {
+        // Decode the image if the thumbnail isn't big enough, it'll be drawn once it's ready
+        if (mThumbnail.isNull() || mThumbnail.width() < camImgRect.width() * lod)
+        {
+            RequestImage();
         }
 
-        QRect camImgRect = QRect(rect().x() + offX, rect().y() + offY, 368, 240);
-
-        aPainter->drawPixmap(camImgRect, mImages.mCamera);
+        if (!mThumbnail.isNull())
+        {
+            aPainter->drawPixmap(camImgRect, mThumbnail);
+        }
+    }
+    else if (!mImages.mCamera.isNull())
+    {
+        // Draw the camera image if we have one
+        aPainter->drawPixmap(camImgRect, CameraPixmapForDrawnWidth(camImgRect.width() * lod));
     }
 
     // Draw the rect outline of the camera
     QGraphicsRectItem::paint(aPainter, aOption, aWidget);
 
-    // Draw the camera name
-    if (mCamera && !mCamera->mName.empty())
+    // Draw the camera name, unless the view is moving and only wants the quick version
+    if (mCamera && !mCamera->mName.empty() && !(pScene && pScene->DraftRendering()))
     {
         aPainter->setBrush(QBrush(QColor::fromRgb(240, 240, 240)));
         aPainter->setPen(Qt::black);
@@ -50,13 +106,261 @@ void CameraGraphicsItem::paint(QPainter* aPainter, const QStyleOptionGraphicsIte
     }
 }
 
+void CameraGraphicsItem::SetImage(QPixmap image)
+{
+    mPendingDecode.reset();
+    mImageLoaded = true;
+    mThumbnail = QPixmap();
+    mImages.mCamera = image;
+    RebuildDisplayedImage();
+    ImageChanged();
+}
+
+void CameraGraphicsItem::SetShowLayers(bool showLayers)
+{
+    if (mShowLayers != showLayers)
+    {
+        mShowLayers = showLayers;
+
+        // An unloaded camera's thumbnail shows the wrong thing now, it's made again after the next decode
+        mThumbnail = QPixmap();
+        RebuildDisplayedImage();
+    }
+}
+
+void CameraGraphicsItem::LayersChanged()
+{
+    // Nothing to do while only the camera image is shown, it'll be made when the layers are turned on
+    if (mShowLayers)
+    {
+        mThumbnail = QPixmap();
+        RebuildDisplayedImage();
+    }
+}
+
 void CameraGraphicsItem::LoadImages()
 {
-    if (mCamera)
+    if (mImageLoaded)
+    {
+        return;
+    }
+
+    mPendingDecode.reset();
+    mImageLoaded = true;
+    if (mCamera && !mCamera->mCameraImageandLayers.mCameraImage.empty())
+    {
+        mImages.mCamera = QPixmap::fromImage(DecodeBase64Image(mCamera->mCameraImageandLayers.mCameraImage));
+    }
+    RebuildDisplayedImage();
+}
+
+void CameraGraphicsItem::RequestImage()
+{
+    if (mImageLoaded || mPendingDecode)
+    {
+        return;
+    }
+
+    if (!mCamera || mCamera->mCameraImageandLayers.mCameraImage.empty())
+    {
+        mImageLoaded = true;
+        return;
+    }
+
+    mPendingDecode = std::make_shared<PendingDecode>();
+    mPendingDecode->mItem = this;
+
+    // Same as the displayed image, QImage on the worker and the item is only touched back on the GUI thread
+    const std::string base64 = mCamera->mCameraImageandLayers.mCameraImage;
+    const std::weak_ptr<PendingDecode> weakPendingDecode = mPendingDecode;
+    QThreadPool::globalInstance()->start([base64, weakPendingDecode]()
+    {
+        const QImage image = DecodeBase64Image(base64);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [weakPendingDecode, image]()
+        {
+            std::shared_ptr<PendingDecode> pPendingDecode = weakPendingDecode.lock();
+            if (pPendingDecode)
+            {
+                pPendingDecode->mItem->ImageDecoded(image);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CameraGraphicsItem::ImageDecoded(const QImage& image)
+{
+    mPendingDecode.reset();
+    mImageLoaded = true;
+    mImages.mCamera = QPixmap::fromImage(image);
+    RebuildDisplayedImage();
+    update();
+    ImageChanged();
+
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene)
+    {
+        pScene->EnforceCameraImageBudget();
+    }
+}
+
+void CameraGraphicsItem::ImageChanged()
+{
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene)
+    {
+        pScene->ItemAppearanceChanged(this);
+    }
+}
+
+void CameraGraphicsItem::UnloadImage()
+{
+    if (!mImageLoaded)
+    {
+        return;
+    }
+
+    // The smallest level that is still at least the thumbnail size, if the levels aren't ready yet
+    // the full image is scaled down here
+    const QPixmap& fullImage = mDisplayedImage->mFullImage.isNull() ? mImages.mCamera : mDisplayedImage->mFullImage;
+    mThumbnail = QPixmap();
+    for (const QPixmap& level : mDisplayedImage->mLevels)
+    {
+        if (level.width() < kThumbnailWidth)
+        {
+            break;
+        }
+        mThumbnail = level;
+    }
+
+    if (mThumbnail.isNull() && !fullImage.isNull())
+    {
+        mThumbnail = fullImage.width() > kThumbnailWidth ? fullImage.scaledToWidth(kThumbnailWidth, Qt::SmoothTransformation) : fullImage;
+    }
+
+    mImageLoaded = false;
+    mImages.mCamera = QPixmap();
+    mDisplayedImage = std::make_shared<DisplayedImage>();
+    mDisplayedImage->mItem = this;
+}
+
+qint64 CameraGraphicsItem::ImageBytes() const
+{
+    qint64 bytes = PixmapBytes(mImages.mCamera) + PixmapBytes(mDisplayedImage->mFullImage);
+    for (const QPixmap& level : mDisplayedImage->mLevels)
+    {
+        bytes += PixmapBytes(level);
+    }
+    return bytes;
+}
+
+bool CameraGraphicsItem::HasLayers() const
+{
+    if (!mCamera)
+    {
+        return false;
+    }
+
+    const auto& layers = mCamera->mCameraImageandLayers;
+    return !layers.mForegroundLayer.empty() || !layers.mBackgroundLayer.empty() || !layers.mForegroundWellLayer.empty() || !layers.mBackgroundWellLayer.empty();
+}
+
+// Draws the layers back to front over the camera image, scaled to it if they are a different size
+static QImage BlendCameraLayers(const QImage& cameraImage, const std::vector<std::string>& layersBase64)
+{
+    QImage blended = cameraImage.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&blended);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (const std::string& layerBase64 : layersBase64)
+    {
+        if (layerBase64.empty())
+        {
+            continue;
+        }
+
+        QImage layer;
+        if (layer.loadFromData(QByteArray::fromBase64(QByteArray(layerBase64.c_str(), static_cast<int>(layerBase64.length())))))
+        {
+            painter.drawImage(blended.rect(), layer);
+        }
+    }
+    painter.end();
+    return blended;
+}
+
+void CameraGraphicsItem::RebuildDisplayedImage()
+{
+    // Drops anything made for the old image, a build still running for it will find nothing to give it to
+    mDisplayedImage = std::make_shared<DisplayedImage>();
+    mDisplayedImage->mItem = this;
+
+    if (mImages.mCamera.isNull())
+    {
+        return;
+    }
+
+    // Copies of the encoded layers so the worker doesn't touch the model
+    const bool blendLayers = mShowLayers && HasLayers();
+    std::vector<std::string> layersBase64;
+    if (blendLayers)
+    {
+        const auto& layers = mCamera->mCameraImageandLayers;
+        layersBase64 = { layers.mBackgroundWellLayer, layers.mBackgroundLayer, layers.mForegroundWellLayer, layers.mForegroundLayer };
+    }
+
+    // QPixmap can only be used on the GUI thread so work with QImages and convert them when they come back
+    const QImage source = mImages.mCamera.toImage();
+    const std::weak_ptr<DisplayedImage> weakDisplayedImage = mDisplayedImage;
+    QThreadPool::globalInstance()->start([source, blendLayers, layersBase64, weakDisplayedImage]()
+    {
+        QImage fullImage;
+        if (blendLayers)
+        {
+            fullImage = BlendCameraLayers(source, layersBase64);
+        }
+
+        std::vector<QImage> levels;
+        QImage level = blendLayers ? fullImage : source;
+        while (level.width() / 2 >= kMinMipWidth)
+        {
+            level = level.scaled(level.width() / 2, level.height() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            levels.push_back(level);
+        }
+
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [weakDisplayedImage, fullImage, levels]()
+        {
+            std::shared_ptr<DisplayedImage> pDisplayedImage = weakDisplayedImage.lock();
+            if (!pDisplayedImage)
+            {
+                return;
+            }
+
+            if (!fullImage.isNull())
+            {
+                pDisplayedImage->mFullImage = QPixmap::fromImage(fullImage);
+            }
+
+            for (const QImage& levelImage : levels)
+            {
+                pDisplayedImage->mLevels.push_back(QPixmap::fromImage(levelImage));
+            }
+            pDisplayedImage->mItem->update();
+            pDisplayedImage->mItem->ImageChanged();
+        }, Qt::QueuedConnection);
+    });
+}
+
+const QPixmap& CameraGraphicsItem::CameraPixmapForDrawnWidth(qreal drawnWidth) const
+{
+    // Use the smallest level that still has at least as many pixels as are drawn, until the
+    // levels are ready this is always the full image
+    const QPixmap* pBest = mDisplayedImage->mFullImage.isNull() ? &mImages.mCamera : &mDisplayedImage->mFullImage;
+    for (const QPixmap& level : mDisplayedImage->mLevels)
     {
-        if (!mCamera->mCameraImageandLayers.mCameraImage.empty())
+        if (level.width() < drawnWidth)
         {
-            mImages.mCamera.loadFromData(QByteArray::fromBase64(QByteArray(mCamera->mCameraImageandLayers.mCameraImage.c_str(), static_cast<int>(mCamera->mCameraImageandLayers.mCameraImage.length()))));
+            break;
         }
+        pBest = &level;
     }
-}
\ No newline at end of file
+    return *pBest;
+}
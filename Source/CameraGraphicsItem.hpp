@@ -2,13 +2,17 @@
 
 #include <QGraphicsRectItem>
 #include <QPixmap>
+#include <memory>
+#include <vector>
 
 struct Camera;
 
 class CameraGraphicsItem final : public QGraphicsRectItem
 {
 public:
-    CameraGraphicsItem(Camera* pCamera, int xpos, int ypos, int width, int height, int transparency);
+    CameraGraphicsItem(Camera* pCamera, int xpos, int ypos, int width, int height);
+    enum { Type = UserType + 4 };
+    int type() const override { return Type; }
     void paint(QPainter* aPainter, const QStyleOptionGraphicsItem* aOption, QWidget* aWidget) override;
 
     const Camera* GetCamera() const
@@ -21,17 +25,47 @@ public:
         return mCamera;
     }
 
-    void SetImage(QPixmap image)
-    {
-        mImages.mCamera = image;
-    }
+    void SetImage(QPixmap image);
+
+    // Blend the foreground, background and well layers over the camera image instead of only
+    // drawing the camera image
+    void SetShowLayers(bool showLayers);
 
+    // Call after one of the cameras layers changed so the blended image is made again
+    void LayersChanged();
+
+    // Decodes the image right away if it hasn't been yet
     QPixmap GetImage()
     {
+        LoadImages();
         return mImages.mCamera;
     }
+
+    // Starts decoding the image on a worker thread unless it's already decoded or being decoded
+    void RequestImage();
+
+    // Frees the decoded image and everything made from it except for a small thumbnail, the image
+    // is decoded again the next time it's drawn bigger than that
+    void UnloadImage();
+
+    bool ImageLoaded() const
+    {
+        return mImageLoaded;
+    }
+
+    // Roughly how much memory the decoded image and the copies made from it take
+    qint64 ImageBytes() const;
+
 private:
     void LoadImages();
+    void ImageDecoded(const QImage& image);
+
+    // Tells the scene, and so the minimap, that a different image is drawn now
+    void ImageChanged();
+    void RebuildDisplayedImage();
+    bool HasLayers() const;
+    // drawnWidth is how many device pixels wide the image ends up, not the width of the image
+    const QPixmap& CameraPixmapForDrawnWidth(qreal drawnWidth) const;
 
     Camera* mCamera = nullptr;
     struct Images final
@@ -39,4 +73,31 @@ private:
         QPixmap mCamera;
     };
     Images mImages;
+
+    // Nothing is decoded until the camera is first drawn or prefetched
+    bool mImageLoaded = false;
+    QPixmap mThumbnail;
+
+    // Replaced or dropped whenever the decode it's for is no longer wanted
+    struct PendingDecode final
+    {
+        CameraGraphicsItem* mItem = nullptr;
+    };
+    std::shared_ptr<PendingDecode> mPendingDecode;
+
+    bool mShowLayers = false;
+
+    // What paint draws: the camera image or the layers blended over it, along with half, quarter etc
+    // size copies so a zoomed out view doesn't scale the full image down every frame. Made on a
+    // worker thread and replaced whenever the image changes, so a build that finishes for an old
+    // image or a deleted item has nowhere to go.
+    struct DisplayedImage final
+    {
+        CameraGraphicsItem* mItem = nullptr;
+
+        // Null until a blended image is ready, the camera image is drawn until then
+        QPixmap mFullImage;
+        std::vector<QPixmap> mLevels;
+    };
+    std::shared_ptr<DisplayedImage> mDisplayedImage;
 };
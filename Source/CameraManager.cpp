@@ -201,6 +201,12 @@ private:
             mCameraGraphicsItem->GetCamera()->mCameraImageandLayers.mBackgroundWellLayer = PixmapToBase64PngString(img);
             break;
         };
+
+        // The camera image is handled by SetImage
+        if (mImgIdx != Main)
+        {
+            mCameraGraphicsItem->LayersChanged();
+        }
     }
 
     CameraGraphicsItem* mCameraGraphicsItem = nullptr;
@@ -255,7 +261,7 @@ public:
     void undo() override
     {
         // Remove "blank" graphics item
-        mTab->GetScene().removeItem(mEmptyCamera);
+        mTab->GetScene().RemoveItem(mEmptyCamera);
         mEmptyCameraModel = mTab->GetModel().RemoveCamera(mEmptyCamera->GetCamera());
 
         // Move empty camera map objects to original camera
@@ -263,12 +269,12 @@ public:
 
         // Add back the original camera
         mTab->GetModel().AddCamera(std::move(mCameraOriginalModel));
-        mTab->GetScene().addItem(mCameraOriginal);
+        mTab->GetScene().AddItem(mCameraOriginal);
 
         // Add map objects back to the graphics scene
         for (auto& item : mGraphicsItemMapObjects)
         {
-            mTab->GetScene().addItem(item);
+            mTab->GetScene().AddItem(item);
         }
 
         // Update camera manager UI if open
@@ -286,7 +292,7 @@ public:
     {
         // Remove original camera
         mCameraOriginalModel = mTab->GetModel().RemoveCamera(mCameraOriginal->GetCamera());
-        mTab->GetScene().removeItem(mCameraOriginal);
+        mTab->GetScene().RemoveItem(mCameraOriginal);
 
         // Move original map objects to blank camera
         mEmptyCameraModel->mMapObjects = std::move(mCameraOriginalModel->mMapObjects);
@@ -294,10 +300,10 @@ public:
         // Remove map object graphics items
         for (auto& item : mGraphicsItemMapObjects)
         {
-            mTab->GetScene().removeItem(item);
+            mTab->GetScene().RemoveItem(item);
         }
         // Add "blank" camera
-        mTab->GetScene().addItem(mEmptyCamera);
+        mTab->GetScene().AddItem(mEmptyCamera);
         mTab->GetModel().AddCamera(std::move(mEmptyCameraModel));
 
         // Update camera manager UI if open
@@ -372,6 +378,9 @@ CameraManager::CameraManager(QWidget *parent, EditorTab* pParentTab, const QPoin
 {
     ui->setupUi(this);
 
+    // Every camera in the list needs its graphics item
+    mTab->PopulateAllItems();
+
     const MapInfo& mapInfo = mTab->GetModel().GetMapInfo();
 
     const auto& cameras = mTab->GetModel().GetCameras();
@@ -593,19 +602,7 @@ CameraGraphicsItem* CameraManager::CameraGraphicsItemByPos(const QPoint& pos)
 
 CameraGraphicsItem* CameraManager::CameraGraphicsItemByModelPtr(const Camera* cam)
 {
-    QList<QGraphicsItem*> itemsAtPos = mTab->GetScene().items();
-    for (int i = 0; i < itemsAtPos.count(); i++)
-    {
-        CameraGraphicsItem* pCameraGraphicsItem = qgraphicsitem_cast<CameraGraphicsItem*>(itemsAtPos.at(i));
-        if (pCameraGraphicsItem)
-        {
-            if (pCameraGraphicsItem->GetCamera() == cam)
-            {
-                return pCameraGraphicsItem;
-            }
-        }
-    }
-    return nullptr;
+    return mTab->GetScene().CameraItemFor(cam);
 }
 
 void CameraManager::on_btnDeleteImage_clicked()
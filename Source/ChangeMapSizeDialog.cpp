@@ -7,6 +7,7 @@
 #include "ResizeableRectItem.hpp"
 #include "CameraGraphicsItem.hpp"
 #include <QDebug>
+#include <map>
 
 struct RemovedCamera final
 {
@@ -44,10 +45,10 @@ struct RemovedCamera final
         mCameraModel = model.RemoveCamera(mCameraGraphicsItem->GetCamera());
 
         // Remove graphics items from the scene
-        pScene->removeItem(mCameraGraphicsItem);
+        pScene->RemoveItem(mCameraGraphicsItem);
         for (auto& mapObject : mGraphicsItemMapObjects)
         {
-            pScene->removeItem(mapObject);
+            pScene->RemoveItem(mapObject);
         }
     }
 
@@ -57,10 +58,10 @@ struct RemovedCamera final
         model.AddCamera(std::move(mCameraModel));
 
         // Add graphics items to the scene
-        pScene->addItem(mCameraGraphicsItem);
+        pScene->AddItem(mCameraGraphicsItem);
         for (auto& mapObject : mGraphicsItemMapObjects)
         {
-            pScene->addItem(mapObject);
+            pScene->AddItem(mapObject);
         }
     }
 };
@@ -77,16 +78,16 @@ struct CamToEdit final
     }
 };
 
-static void Add(std::vector<CamToEdit>& edits, int x, int y, bool add)
+static void Add(std::vector<CamToEdit>& edits, std::map<std::pair<int, int>, size_t>& editIndices, int x, int y, bool add)
 {
-    for (auto& edit : edits)
+    // The column and row loops can both want the same corner cell, the last one wins
+    auto it = editIndices.find({ x, y });
+    if (it != editIndices.end())
     {
-        if (edit.x == x && edit.y == y)
-        {
-            edit.mAdd = add;
-            return;
-        }
+        edits[it->second].mAdd = add;
+        return;
     }
+    editIndices[{ x, y }] = edits.size();
     edits.push_back(CamToEdit{ x, y, add });
 }
 
@@ -100,6 +101,7 @@ static std::vector<CamToEdit> CalcMapChanges(int oldW, int newW, int oldH, int n
     const int minY = std::min(oldH, newH);
 
     std::vector<CamToEdit> edits;
+    std::map<std::pair<int, int>, size_t> editIndices;
     for (int x = 0; x < maxX; x++)
     {
         for (int y = 0; y < maxY; y++)
@@ -107,23 +109,23 @@ static std::vector<CamToEdit> CalcMapChanges(int oldW, int newW, int oldH, int n
             if (x >= oldW)
             {
                 // add
-                Add(edits, x, y, true);
+                Add(edits, editIndices, x, y, true);
             }
             else if (x >= newW)
             {
                 // remove
-                Add(edits, x, y, false);
+                Add(edits, editIndices, x, y, false);
             }
 
             if (y >= oldH)
             {
                 // add
-                Add(edits, x, y, true);
+                Add(edits, editIndices, x, y, true);
             }
             else if (y >= newH)
             {
                 // remove
-                Add(edits, x, y, false);
+                Add(edits, editIndices, x, y, false);
             }
         }
     }
@@ -279,13 +281,13 @@ struct AddedCamera final
     void undo(Model& model, EditorGraphicsScene* pScene)
     {
         mCameraModel = model.RemoveCamera(mCameraGraphicsItem->GetCamera());
-        pScene->removeItem(mCameraGraphicsItem);
+        pScene->RemoveItem(mCameraGraphicsItem);
     }
 
     void redo(Model& model, EditorGraphicsScene* pScene)
     {
         model.AddCamera(std::move(mCameraModel));
-        pScene->addItem(mCameraGraphicsItem);
+        pScene->AddItem(mCameraGraphicsItem);
     }
 };
 
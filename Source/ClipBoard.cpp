@@ -58,7 +58,7 @@ void PasteItemsCommand::redo()
     // Add to scene
     for (auto& obj : mMapGraphicsObjects)
     {
-        mTab->GetScene().addItem(obj);
+        mTab->GetScene().AddItem(obj);
     }
 
     // Add to model
@@ -71,7 +71,7 @@ void PasteItemsCommand::redo()
     // Add to scene
     for (auto& obj : mCollisionGraphicsObjects)
     {
-        mTab->GetScene().addItem(obj);
+        mTab->GetScene().AddItem(obj);
     }
 
     // Add to model
@@ -111,7 +111,7 @@ void PasteItemsCommand::undo()
         mMapObjects.emplace_back(std::move(pastedMapObject));
 
         // Remove from scene
-        mTab->GetScene().removeItem(obj);
+        mTab->GetScene().RemoveItem(obj);
     }
 
     for (auto& obj : mCollisionGraphicsObjects)
@@ -120,7 +120,7 @@ void PasteItemsCommand::undo()
         mCollisions.emplace_back(mTab->GetModel().RemoveCollisionItem(obj->GetCollisionItem()));
 
         // Remove from scene
-        mTab->GetScene().removeItem(obj);
+        mTab->GetScene().RemoveItem(obj);
     }
 
     mPasted = false;
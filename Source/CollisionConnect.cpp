@@ -1,6 +1,8 @@
 #include "CollisionConnect.hpp"
+#include "EditorGraphicsScene.hpp"
 
 #include <utility>
+#include <set>
 
 CollisionConnectCommand::CollisionConnectCommand(std::vector<CollisionConnectData> collisionConnectData):
         mCollisionConnectData(std::move(collisionConnectData))
@@ -24,36 +26,33 @@ void CollisionConnectCommand::redo()
     }
 }
 
-std::vector<CollisionConnectData> CollisionConnectCommand::getConnectCollisionsChanges(const std::vector<ResizeableArrowItem*> &collisions)
+std::vector<CollisionConnectData> CollisionConnectCommand::getConnectCollisionsChanges(EditorGraphicsScene& scene, const std::vector<ResizeableArrowItem*> &collisions)
 {
     std::vector<CollisionConnectData> collisionConnectData;
 
-    for (int i = 0; i < collisions.size(); i++)
+    const std::set<ResizeableArrowItem*> selected(collisions.begin(), collisions.end());
+
+    for (auto& collision : collisions)
     {
-        auto& collision = collisions[i];
         auto collisionItem = collision->GetCollisionItem();
         int id = collisionItem->mId;
 
-        int startX = collisionItem->X1();
-        int startY = collisionItem->Y1();
-
         int endX = collisionItem->X2();
         int endY = collisionItem->Y2();
 
-
-        for (int j = i + 1; j < collisions.size(); j++)
+        // Only collisions around the end of this one can start where it ends
+        for (QGraphicsItem* pNearItem : scene.CollisionsAndMapObjectsIn(QRectF(endX - 1, endY - 1, 2, 2)))
         {
-            auto& otherCollision = collisions[j];
+            auto otherCollision = qgraphicsitem_cast<ResizeableArrowItem*>(pNearItem);
+            if (!otherCollision || otherCollision == collision || selected.count(otherCollision) == 0)
+            {
+                continue;
+            }
+
             auto otherCollisionItem = otherCollision->GetCollisionItem();
             int otherId = otherCollisionItem->mId;
 
-            int otherStartX = otherCollisionItem->X1();
-            int otherStartY = otherCollisionItem->Y1();
-
-            int otherEndX = otherCollisionItem->X2();
-            int otherEndY = otherCollisionItem->Y2();
-
-            if (endX == otherStartX && endY == otherStartY)
+            if (endX == otherCollisionItem->X1() && endY == otherCollisionItem->Y1())
             {
                 collisionConnectData.emplace_back(
                         CollisionConnectData(PropertyByName("Next", collisionItem->mProperties), collisionItem->Next(), otherId)
@@ -63,17 +62,6 @@ std::vector<CollisionConnectData> CollisionConnectCommand::getConnectCollisionsC
                         CollisionConnectData(PropertyByName("Previous", otherCollisionItem->mProperties), otherCollisionItem->Previous(), id)
                 );
             }
-
-            if (startX == otherEndX && startY == otherEndY)
-            {
-                collisionConnectData.emplace_back(
-                        CollisionConnectData(PropertyByName("Next", otherCollisionItem->mProperties), otherCollisionItem->Next(), id)
-                );
-                collisionConnectData.emplace_back(
-                        CollisionConnectData(PropertyByName("Previous", collisionItem->mProperties), collisionItem->Previous(), otherId)
-                );
-            }
-
         }
     }
     return collisionConnectData;
@@ -4,6 +4,8 @@
 #include "Model.hpp"
 #include "ResizeableArrowItem.hpp"
 
+class EditorGraphicsScene;
+
 struct CollisionConnectData
 {
     CollisionConnectData(ObjectProperty *mObjectProperty, int mOldValue, int mNewValue) : mObjectProperty(
@@ -26,7 +28,7 @@ public:
 
     void redo() override;
 
-    static std::vector<CollisionConnectData> getConnectCollisionsChanges(const std::vector<ResizeableArrowItem *> &collisions);
+    static std::vector<CollisionConnectData> getConnectCollisionsChanges(EditorGraphicsScene& scene, const std::vector<ResizeableArrowItem *> &collisions);
 
 private:
     std::vector<CollisionConnectData> mCollisionConnectData;
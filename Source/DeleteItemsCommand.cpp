@@ -34,7 +34,7 @@ void DeleteItemsCommand::undo()
     // add back to scene
     for (auto& item : mGraphicsItemsToDelete)
     {
-        mTab->GetScene().addItem(item);
+        mTab->GetScene().AddItem(item);
     }
 
     // add back to model
@@ -68,7 +68,7 @@ void DeleteItemsCommand::redo()
     // remove from scene
     for (auto& item : mGraphicsItemsToDelete)
     {
-        mTab->GetScene().removeItem(item);
+        mTab->GetScene().RemoveItem(item);
 
         ResizeableArrowItem* pArrow = qgraphicsitem_cast<ResizeableArrowItem*>(item);
         if (pArrow)
@@ -9,11 +9,235 @@
 #include "Model.hpp"
 #include <QUndoCommand>
 #include "DeleteItemsCommand.hpp"
+#include "BatchedLayerItem.hpp"
+#include <QTimer>
+#include <algorithm>
+
+// About a frame at 60Hz. Mouse moves arrive about once per event loop turn, which can be a lot
+// more often than the view actually shows a frame.
+static const int kModelSyncIntervalMs = 16;
+
+class LayerGroupItem final : public QGraphicsItem
+{
+public:
+    explicit LayerGroupItem(qreal z)
+    {
+        // Unlike QGraphicsItemGroup the children still get their own events
+        setFlag(ItemHasNoContents);
+        setZValue(z);
+    }
+
+    QRectF boundingRect() const override
+    {
+        return QRectF();
+    }
+
+    void paint(QPainter*, const QStyleOptionGraphicsItem*, QWidget*) override
+    {
+
+    }
+};
 
 EditorGraphicsScene::EditorGraphicsScene(EditorTab* pTab)
     : mTab(pTab)
 {
     ToggleGrid();
+
+    // Children are only stacked against their siblings, so the layers z decide which layer is on top
+    mCameraLayer = new LayerGroupItem(1.0);
+    mCollisionLayer = new LayerGroupItem(2.0);
+    mMapObjectLayer = new LayerGroupItem(3.0);
+    addItem(mCameraLayer);
+    addItem(mCollisionLayer);
+    addItem(mMapObjectLayer);
+
+    mBatchedCollisions = new BatchedLayerItem(BatchedLayerItem::Kind::CollisionLines);
+    mBatchedMapObjects = new BatchedLayerItem(BatchedLayerItem::Kind::MapObjects);
+    mBatchedCollisions->setVisible(false);
+    mBatchedMapObjects->setVisible(false);
+    mBatchedCollisions->setParentItem(mCollisionLayer);
+    mBatchedMapObjects->setParentItem(mMapObjectLayer);
+    SyncTransparencySettings();
+
+    mModelSyncTimer.setSingleShot(true);
+    mModelSyncTimer.setInterval(kModelSyncIntervalMs);
+    connect(&mModelSyncTimer, &QTimer::timeout, this, &EditorGraphicsScene::FlushModelSync);
+}
+
+void EditorGraphicsScene::AddItem(QGraphicsItem* pItem)
+{
+    // Parenting to a layer that is in the scene adds the item to the scene too
+    if (auto pCameraItem = qgraphicsitem_cast<CameraGraphicsItem*>(pItem))
+    {
+        pItem->setParentItem(mCameraLayer);
+        pCameraItem->SetShowLayers(mShowCameraLayers);
+        if (pCameraItem->GetCamera())
+        {
+            mCameraItems[{ pCameraItem->GetCamera()->mX, pCameraItem->GetCamera()->mY }] = pCameraItem;
+        }
+        ItemAppearanceChanged(pItem);
+    }
+    else if (auto pRectItem = qgraphicsitem_cast<ResizeableRectItem*>(pItem))
+    {
+        pItem->setParentItem(mMapObjectLayer);
+        mMapObjectItems.insert(pRectItem->GetMapObject(), pRectItem);
+        mSpatialIndex.Update(pItem, pItem->sceneBoundingRect());
+        InvalidateBatchedItem(pItem);
+    }
+    else if (qgraphicsitem_cast<ResizeableArrowItem*>(pItem))
+    {
+        pItem->setParentItem(mCollisionLayer);
+        mSpatialIndex.Update(pItem, pItem->sceneBoundingRect());
+        InvalidateBatchedItem(pItem);
+    }
+    else
+    {
+        addItem(pItem);
+        ItemAppearanceChanged(pItem);
+    }
+}
+
+void EditorGraphicsScene::RemoveItem(QGraphicsItem* pItem)
+{
+    ItemAppearanceChanged(pItem);
+
+    if (auto pCameraItem = qgraphicsitem_cast<CameraGraphicsItem*>(pItem))
+    {
+        if (pCameraItem->GetCamera())
+        {
+            // Another item might have already taken this position, e.g. the empty camera that replaces a deleted one
+            auto it = mCameraItems.find({ pCameraItem->GetCamera()->mX, pCameraItem->GetCamera()->mY });
+            if (it != mCameraItems.end() && it->second == pCameraItem)
+            {
+                mCameraItems.erase(it);
+            }
+        }
+    }
+    else if (auto pRectItem = qgraphicsitem_cast<ResizeableRectItem*>(pItem))
+    {
+        auto it = mMapObjectItems.find(pRectItem->GetMapObject());
+        if (it != mMapObjectItems.end() && it.value() == pRectItem)
+        {
+            mMapObjectItems.erase(it);
+        }
+    }
+
+    mSpatialIndex.Remove(pItem);
+    mPendingBatchedItems.remove(pItem);
+    mDraftPaintedItems.remove(pItem);
+    mBatchedCollisions->RemoveItem(pItem);
+    mBatchedMapObjects->RemoveItem(pItem);
+    if (mPendingModelSync.contains(pItem))
+    {
+        FlushModelSync();
+    }
+    if (mHoveredItem == pItem)
+    {
+        SetHoveredItem(nullptr);
+    }
+
+    // Leave it without a parent so it can be added back to a scene on its own
+    pItem->setParentItem(nullptr);
+    removeItem(pItem);
+}
+
+void EditorGraphicsScene::ItemGeometryChanged(QGraphicsItem* pItem)
+{
+    // Where it was, InvalidateBatchedItem reports where it is now
+    const QRectF oldBounds = mSpatialIndex.Bounds(pItem);
+    if (!oldBounds.isNull())
+    {
+        emit ContentChanged(oldBounds);
+    }
+
+    mSpatialIndex.Update(pItem, pItem->sceneBoundingRect());
+    InvalidateBatchedItem(pItem);
+}
+
+void EditorGraphicsScene::QueueModelSync(QGraphicsItem* pItem)
+{
+    // Only started when nothing is pending, so later moves don't push the flush back and a long
+    // drag still writes the items once per interval
+    if (!mModelSyncTimer.isActive())
+    {
+        mModelSyncTimer.start();
+    }
+    mPendingModelSync.insert(pItem);
+}
+
+void EditorGraphicsScene::FlushModelSync()
+{
+    mModelSyncTimer.stop();
+    if (mPendingModelSync.isEmpty())
+    {
+        return;
+    }
+
+    const QSet<QGraphicsItem*> pending = std::move(mPendingModelSync);
+    mPendingModelSync.clear();
+    for (QGraphicsItem* pItem : pending)
+    {
+        if (auto pRectItem = qgraphicsitem_cast<ResizeableRectItem*>(pItem))
+        {
+            pRectItem->SyncModel();
+        }
+        else if (auto pArrowItem = qgraphicsitem_cast<ResizeableArrowItem*>(pItem))
+        {
+            pArrowItem->SyncModel();
+        }
+    }
+
+    // Once for all of them, refreshing per item would look each one up in the shown items
+    mTab->RefreshPropertyEditorValues();
+}
+
+QList<QGraphicsItem*> EditorGraphicsScene::CollisionsAndMapObjectsAt(const QPointF& pos) const
+{
+    QList<QGraphicsItem*> found;
+    for (QGraphicsItem* pItem : mSpatialIndex.ItemsAt(pos))
+    {
+        // The index only knows the bounds, the shape of a diagonal collision is much smaller
+        if (pItem->isVisible() && pItem->contains(pItem->mapFromScene(pos)))
+        {
+            found.append(pItem);
+        }
+    }
+
+    // The layer decides the order first, then the items place within it
+    std::stable_sort(found.begin(), found.end(), [](const QGraphicsItem* a, const QGraphicsItem* b)
+    {
+        const qreal aLayerZ = a->topLevelItem()->zValue();
+        const qreal bLayerZ = b->topLevelItem()->zValue();
+        if (aLayerZ != bLayerZ)
+        {
+            return aLayerZ > bLayerZ;
+        }
+        return a->zValue() > b->zValue();
+    });
+    return found;
+}
+
+QList<QGraphicsItem*> EditorGraphicsScene::CollisionsAndMapObjectsIn(const QRectF& rect) const
+{
+    return mSpatialIndex.ItemsIn(rect);
+}
+
+QList<ResizeableRectItem*> EditorGraphicsScene::MapObjectsInRect(const QRectF& rect) const
+{
+    QList<ResizeableRectItem*> found;
+    for (QGraphicsItem* pItem : mSpatialIndex.ItemsIn(rect))
+    {
+        ResizeableRectItem* pRectItem = qgraphicsitem_cast<ResizeableRectItem*>(pItem);
+        if (pRectItem)
+        {
+            const QPoint midPoint = pRectItem->CurrentRect().center().toPoint();
+            if (midPoint.x() >= rect.left() && midPoint.x() < rect.right() && midPoint.y() >= rect.top() && midPoint.y() < rect.bottom())
+            {
+                found.append(pRectItem);
+            }
+        }
+    }
+    return found;
 }
 
 QList<ResizeableRectItem*> EditorGraphicsScene::MapObjectsForCamera(CameraGraphicsItem* pCameraGraphicsItem)
@@ -21,20 +245,13 @@ QList<ResizeableRectItem*> EditorGraphicsScene::MapObjectsForCamera(CameraGraphi
     const auto& modelMapObjects = pCameraGraphicsItem->GetCamera()->mMapObjects;
 
     QList<ResizeableRectItem*> graphicsItemMapObjects;
-    QList<QGraphicsItem*> allItems = items();
-    for (QGraphicsItem* item : allItems)
+    graphicsItemMapObjects.reserve(static_cast<int>(modelMapObjects.size()));
+    for (auto& mapModelObj : modelMapObjects)
     {
-        ResizeableRectItem* pCastedGraphicsItemMapObject = qgraphicsitem_cast<ResizeableRectItem*>(item);
-        if (pCastedGraphicsItemMapObject)
+        ResizeableRectItem* pItem = MapObjectItemFor(mapModelObj.get());
+        if (pItem)
         {
-            for (auto& mapModelObj : modelMapObjects)
-            {
-                if (mapModelObj.get() == pCastedGraphicsItemMapObject->GetMapObject())
-                {
-                    graphicsItemMapObjects.append(pCastedGraphicsItemMapObject);
-                    break;
-                }
-            }
+            graphicsItemMapObjects.append(pItem);
         }
     }
     return graphicsItemMapObjects;
@@ -50,53 +267,243 @@ void EditorGraphicsScene::UpdateSceneRect()
 
 CameraGraphicsItem* EditorGraphicsScene::CameraAt(int x, int y)
 {
-    QList<QGraphicsItem*> allItems = items();
-    for (QGraphicsItem* item : allItems)
+    auto it = mCameraItems.find({ x, y });
+    return it != mCameraItems.end() ? it->second : nullptr;
+}
+
+CameraGraphicsItem* EditorGraphicsScene::CameraItemFor(const Camera* pCamera)
+{
+    CameraGraphicsItem* pCameraItem = CameraAt(pCamera->mX, pCamera->mY);
+    return pCameraItem && pCameraItem->GetCamera() == pCamera ? pCameraItem : nullptr;
+}
+
+ResizeableRectItem* EditorGraphicsScene::MapObjectItemFor(const MapObject* pMapObject)
+{
+    return mMapObjectItems.value(pMapObject, nullptr);
+}
+
+TransparencySettings& EditorGraphicsScene::GetTransparencySettings()
+{
+    return mTransparencySettings;
+}
+
+void EditorGraphicsScene::SetBatchedRendering(bool enabled)
+{
+    if (mBatchedRendering == enabled)
     {
-        CameraGraphicsItem* pCameraItem = qgraphicsitem_cast<CameraGraphicsItem*>(item);
-        if (pCameraItem)
+        return;
+    }
+
+    mBatchedRendering = enabled;
+    mBatchedCollisions->setVisible(enabled);
+    mBatchedMapObjects->setVisible(enabled);
+
+    if (enabled)
+    {
+        RebuildBatchedLayers();
+    }
+
+    // The items need to draw themselves again or stop doing so
+    for (QGraphicsItem* pItem : items())
+    {
+        pItem->update();
+    }
+}
+
+void EditorGraphicsScene::SetDraftRendering(bool draft)
+{
+    mDraftRendering = draft;
+    UpdateDraftPaintedItems();
+}
+
+void EditorGraphicsScene::SetMinimapRendering(bool minimap)
+{
+    mMinimapRendering = minimap;
+    UpdateDraftPaintedItems();
+}
+
+void EditorGraphicsScene::UpdateDraftPaintedItems()
+{
+    if (DraftRendering())
+    {
+        return;
+    }
+
+    // Changing the render hints doesn't invalidate an item cache but update does
+    for (QGraphicsItem* pItem : mDraftPaintedItems)
+    {
+        pItem->update();
+    }
+    mDraftPaintedItems.clear();
+}
+
+void EditorGraphicsScene::ItemAppearanceChanged(QGraphicsItem* pItem)
+{
+    emit ContentChanged(pItem->sceneBoundingRect());
+}
+
+void EditorGraphicsScene::InvalidateBatchedItem(QGraphicsItem* pItem)
+{
+    ItemAppearanceChanged(pItem);
+
+    if (!mBatchedRendering)
+    {
+        return;
+    }
+
+    // Many items can change at once (a drag, undo, paste) so they are all updated together
+    if (mPendingBatchedItems.isEmpty())
+    {
+        QTimer::singleShot(0, this, &EditorGraphicsScene::FlushBatchedItems);
+    }
+    mPendingBatchedItems.insert(pItem);
+}
+
+void EditorGraphicsScene::FlushBatchedItems()
+{
+    const QSet<QGraphicsItem*> pending = std::move(mPendingBatchedItems);
+    mPendingBatchedItems.clear();
+    if (!mBatchedRendering)
+    {
+        return;
+    }
+
+    for (QGraphicsItem* pItem : pending)
+    {
+        // Removed items were already taken out of the batched layers by RemoveItem
+        if (mSpatialIndex.Contains(pItem))
         {
-            if (pCameraItem->GetCamera()->mX == x && pCameraItem->GetCamera()->mY == y)
-            {
-                return pCameraItem;
-            }
+            mBatchedCollisions->UpdateItem(pItem);
+            mBatchedMapObjects->UpdateItem(pItem);
         }
     }
-    return nullptr;
 }
 
-TransparencySettings& EditorGraphicsScene::GetTransparencySettings()
+void EditorGraphicsScene::RebuildBatchedLayers()
 {
-    return mTransparencySettings;
+    mPendingBatchedItems.clear();
+    mBatchedCollisions->Rebuild(mCollisionLayer->childItems());
+    mBatchedMapObjects->Rebuild(mMapObjectLayer->childItems());
 }
 
 void EditorGraphicsScene::SyncTransparencySettings()
 {
-    QList<QGraphicsItem*> objs = items();
-    for (auto& obj : objs)
+    IGraphicsItem::SetTransparency(mCameraLayer, mTransparencySettings.CameraTransparency());
+    IGraphicsItem::SetTransparency(mCollisionLayer, mTransparencySettings.CollisionTransparency());
+    IGraphicsItem::SetTransparency(mMapObjectLayer, mTransparencySettings.MapObjectTransparency());
+    emit ContentChanged(sceneRect());
+}
+
+void EditorGraphicsScene::SetShowCameraLayers(bool show)
+{
+    if (mShowCameraLayers == show)
+    {
+        return;
+    }
+
+    mShowCameraLayers = show;
+    for (QGraphicsItem* pItem : mCameraLayer->childItems())
     {
-        auto pCameraGraphicsItem = qgraphicsitem_cast<CameraGraphicsItem*>(obj);
-        if (pCameraGraphicsItem)
+        auto pCameraItem = qgraphicsitem_cast<CameraGraphicsItem*>(pItem);
+        if (pCameraItem)
         {
-            IGraphicsItem::SetTransparency(pCameraGraphicsItem, mTransparencySettings.CameraTransparency());
+            pCameraItem->SetShowLayers(show);
         }
-        else
+    }
+    emit ContentChanged(sceneRect());
+}
+
+void EditorGraphicsScene::SetCameraImageBudget(qint64 bytes)
+{
+    mCameraImageBudget = bytes;
+    EnforceCameraImageBudget();
+}
+
+void EditorGraphicsScene::UpdateCameraImages(const QRectF& keepRect)
+{
+    mCameraImageKeepRect = keepRect;
+    for (const auto& [pos, pCameraItem] : mCameraItems)
+    {
+        if (pCameraItem->sceneBoundingRect().intersects(keepRect))
         {
-            auto pResizeableArrowItem = qgraphicsitem_cast<ResizeableArrowItem*>(obj);
-            if (pResizeableArrowItem)
-            {
-                pResizeableArrowItem->SetTransparency(pResizeableArrowItem, mTransparencySettings.CollisionTransparency());
-            }
-            else
-            {
-                auto pResizeableRectItem = qgraphicsitem_cast<ResizeableRectItem*>(obj);
-                if (pResizeableRectItem)
-                {
-                    pResizeableRectItem->SetTransparency(pResizeableRectItem, mTransparencySettings.MapObjectTransparency());
-                }
-            }
+            pCameraItem->RequestImage();
         }
     }
+    EnforceCameraImageBudget();
+}
+
+void EditorGraphicsScene::EnforceCameraImageBudget()
+{
+    qint64 totalBytes = 0;
+    std::vector<CameraGraphicsItem*> evictable;
+    for (const auto& [pos, pCameraItem] : mCameraItems)
+    {
+        if (!pCameraItem->ImageLoaded())
+        {
+            continue;
+        }
+
+        totalBytes += pCameraItem->ImageBytes();
+        if (!pCameraItem->sceneBoundingRect().intersects(mCameraImageKeepRect))
+        {
+            evictable.push_back(pCameraItem);
+        }
+    }
+
+    if (totalBytes <= mCameraImageBudget)
+    {
+        return;
+    }
+
+    // Furthest from the area being looked at goes first
+    const QPointF keepCentre = mCameraImageKeepRect.center();
+    auto distanceToKeep = [&](CameraGraphicsItem* pCameraItem)
+    {
+        const QPointF delta = pCameraItem->sceneBoundingRect().center() - keepCentre;
+        return QPointF::dotProduct(delta, delta);
+    };
+    std::sort(evictable.begin(), evictable.end(), [&](CameraGraphicsItem* a, CameraGraphicsItem* b)
+    {
+        return distanceToKeep(a) > distanceToKeep(b);
+    });
+
+    for (CameraGraphicsItem* pCameraItem : evictable)
+    {
+        if (totalBytes <= mCameraImageBudget)
+        {
+            break;
+        }
+        totalBytes -= pCameraItem->ImageBytes();
+        pCameraItem->UnloadImage();
+    }
+}
+
+QGraphicsItem* EditorGraphicsScene::LayerItem(Layer layer) const
+{
+    switch (layer)
+    {
+    case Layer::Cameras:
+        return mCameraLayer;
+    case Layer::Collisions:
+        return mCollisionLayer;
+    case Layer::MapObjects:
+        return mMapObjectLayer;
+    }
+    return nullptr;
+}
+
+void EditorGraphicsScene::SetLayerVisible(Layer layer, bool visible)
+{
+    LayerItem(layer)->setVisible(visible);
+    emit ContentChanged(sceneRect());
+
+    // Picked up again on the next mouse move if it's still under the mouse
+    SetHoveredItem(nullptr);
+}
+
+bool EditorGraphicsScene::LayerVisible(Layer layer) const
+{
+    return LayerItem(layer)->isVisible();
 }
 
 void EditorGraphicsScene::CreateBackgroundBrush()
@@ -147,6 +554,7 @@ void EditorGraphicsScene::ToggleGrid()
         QBrush b;
         setBackgroundBrush(b);
     }
+    emit ContentChanged(sceneRect());
 }
 
 void EditorGraphicsScene::mousePressEvent(QGraphicsSceneMouseEvent* pEvent)
@@ -192,6 +600,59 @@ void EditorGraphicsScene::mousePressEvent(QGraphicsSceneMouseEvent* pEvent)
 void EditorGraphicsScene::mouseMoveEvent(QGraphicsSceneMouseEvent* pEvent)
 {
     QGraphicsScene::mouseMoveEvent(pEvent);
+
+    // Like Qt's hover events nothing changes while a button is held, the item being dragged keeps it
+    if (pEvent->buttons() != Qt::NoButton)
+    {
+        return;
+    }
+
+    const QList<QGraphicsItem*> itemsUnderMouse = CollisionsAndMapObjectsAt(pEvent->scenePos());
+    SetHoveredItem(itemsUnderMouse.isEmpty() ? nullptr : itemsUnderMouse.first());
+
+    auto pRectItem = qgraphicsitem_cast<ResizeableRectItem*>(mHoveredItem);
+    if (pRectItem)
+    {
+        pRectItem->HoverMove(pRectItem->mapFromScene(pEvent->scenePos()));
+    }
+
+    auto pArrowItem = qgraphicsitem_cast<ResizeableArrowItem*>(mHoveredItem);
+    if (pArrowItem)
+    {
+        pArrowItem->HoverMove(pArrowItem->mapFromScene(pEvent->scenePos()), pEvent->modifiers());
+    }
+}
+
+void EditorGraphicsScene::SetHoveredItem(QGraphicsItem* pItem)
+{
+    if (mHoveredItem == pItem)
+    {
+        return;
+    }
+
+    auto pOldRectItem = qgraphicsitem_cast<ResizeableRectItem*>(mHoveredItem);
+    auto pOldArrowItem = qgraphicsitem_cast<ResizeableArrowItem*>(mHoveredItem);
+    if (pOldRectItem)
+    {
+        pOldRectItem->HoverLeave();
+    }
+    else if (pOldArrowItem)
+    {
+        pOldArrowItem->HoverLeave();
+    }
+
+    mHoveredItem = pItem;
+
+    auto pNewRectItem = qgraphicsitem_cast<ResizeableRectItem*>(mHoveredItem);
+    auto pNewArrowItem = qgraphicsitem_cast<ResizeableArrowItem*>(mHoveredItem);
+    if (pNewRectItem)
+    {
+        pNewRectItem->HoverEnter();
+    }
+    else if (pNewArrowItem)
+    {
+        pNewArrowItem->HoverEnter();
+    }
 }
 
 void EditorGraphicsScene::mouseReleaseEvent(QGraphicsSceneMouseEvent* pEvent)
@@ -203,6 +664,9 @@ void EditorGraphicsScene::mouseReleaseEvent(QGraphicsSceneMouseEvent* pEvent)
     {
         qDebug() << "left release";
 
+        // The model has to have the final positions before they are saved for the undo command
+        FlushModelSync();
+
         // Find out what is selected
         QList<QGraphicsItem*> currentSelection = selectedItems();
 
@@ -3,13 +3,19 @@
 #include <QGraphicsScene>
 #include <QKeyEvent>
 #include <map>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include "SpatialIndex.hpp"
 
 class ResizeableArrowItem;
 class ResizeableRectItem;
 class CameraGraphicsItem;
 class Model;
 struct Camera;
+struct MapObject;
 class EditorTab;
+class BatchedLayerItem;
 
 class ItemPositionData final
 {
@@ -138,21 +144,120 @@ class EditorGraphicsScene final : public QGraphicsScene
 public:
     explicit EditorGraphicsScene(EditorTab* pTab);
 
+    // Use these instead of addItem/removeItem so the collisions and map objects stay in the spatial index
+    void AddItem(QGraphicsItem* pItem);
+    void RemoveItem(QGraphicsItem* pItem);
+
+    // A collision or map object moved or was resized
+    void ItemGeometryChanged(QGraphicsItem* pItem);
+
+    // True from a left press until its release, items moved in that time hand their model and
+    // property tree updates to QueueModelSync instead of doing them on every mouse move
+    bool Dragging() const
+    {
+        return mLeftButtonDown;
+    }
+
+    // Writes the item back to the model at most once a frame however many times it moved, and
+    // the property tree is refreshed once for all of the items written
+    void QueueModelSync(QGraphicsItem* pItem);
+    void FlushModelSync();
+
+    // Collisions and map objects under the point, top most first
+    QList<QGraphicsItem*> CollisionsAndMapObjectsAt(const QPointF& pos) const;
+
+    // Hover enter/leave for the collision or map object under the mouse, null when there's none
+    void SetHoveredItem(QGraphicsItem* pItem);
+
+    // Collisions and map objects whose bounds intersect the rect
+    QList<QGraphicsItem*> CollisionsAndMapObjectsIn(const QRectF& rect) const;
+
+    // Map objects whose centre is inside the rect, the same rule CalcContainingCamera uses
+    QList<ResizeableRectItem*> MapObjectsInRect(const QRectF& rect) const;
+
     QList<ResizeableRectItem*> MapObjectsForCamera(CameraGraphicsItem* pCameraGraphicsItem);
 
     void UpdateSceneRect();
 
     CameraGraphicsItem* CameraAt(int x, int y);
+    CameraGraphicsItem* CameraItemFor(const Camera* pCamera);
+    ResizeableRectItem* MapObjectItemFor(const MapObject* pMapObject);
 
     TransparencySettings& GetTransparencySettings();
 
     void SyncTransparencySettings();
     void ToggleGrid();
 
+    enum class Layer
+    {
+        Cameras,
+        Collisions,
+        MapObjects,
+    };
+
+    // Draw each camera with its foreground, background and well layers blended in
+    void SetShowCameraLayers(bool show);
+
+    // Decoded camera images above this many bytes are freed, furthest from the view first
+    void SetCameraImageBudget(qint64 bytes);
+
+    // Starts decoding the images of the cameras in the rect and keeps them from being freed, the
+    // view passes what it's showing plus where it's scrolling to
+    void UpdateCameraImages(const QRectF& keepRect);
+
+    // Frees decoded camera images outside of the last keep rect until they fit in the budget
+    void EnforceCameraImageBudget();
+
+    // A hidden layer and everything in it is skipped when painting and hit testing
+    void SetLayerVisible(Layer layer, bool visible);
+    bool LayerVisible(Layer layer) const;
+
+    // Draws all collisions and map objects from two batched layers instead of an item at a time
+    void SetBatchedRendering(bool enabled);
+    bool BatchedRendering() const
+    {
+        return mBatchedRendering;
+    }
+
+    // Set by the view while it's being panned, zoomed or dragged in, items skip their text
+    void SetDraftRendering(bool draft);
+
+    bool DraftRendering() const
+    {
+        return mDraftRendering || mMinimapRendering;
+    }
+
+    // Set by the minimap while it renders the scene, implies draft rendering and cameras only
+    // draw an image they already have instead of decoding one
+    void SetMinimapRendering(bool minimap);
+
+    bool MinimapRendering() const
+    {
+        return mMinimapRendering;
+    }
+
+    // For cached items painted in draft quality, they are updated when draft rendering ends so
+    // their cache is drawn again at full quality
+    void DraftPainted(QGraphicsItem* pItem)
+    {
+        mDraftPaintedItems.insert(pItem);
+    }
+
+    // Something the batched layers draw about the item changed, its entry is replaced once control
+    // returns to the event loop so a drag only updates the dragged items once per frame
+    void InvalidateBatchedItem(QGraphicsItem* pItem);
+
+    // Reports the item's bounds through ContentChanged, for changes that don't go through
+    // AddItem, RemoveItem or ItemGeometryChanged such as a camera image being decoded
+    void ItemAppearanceChanged(QGraphicsItem* pItem);
 
 signals:
     void SelectionChanged(QList<QGraphicsItem*> oldItems, QList<QGraphicsItem*> newItems);
     void ItemsMoved(ItemPositionData oldPositions, ItemPositionData newPositions);
+
+    // What the scene draws changed inside the rect. Unlike QGraphicsScene::changed connecting to
+    // this doesn't make the views repaint through updateScene.
+    void ContentChanged(const QRectF& sceneRect);
 private:
     void mousePressEvent(QGraphicsSceneMouseEvent* pEvent) override;
     void mouseMoveEvent(QGraphicsSceneMouseEvent* pEvent) override;
@@ -161,6 +266,10 @@ private:
     void keyPressEvent(QKeyEvent* keyEvent) override;
 
     void CreateBackgroundBrush();
+    void RebuildBatchedLayers();
+    void FlushBatchedItems();
+    void UpdateDraftPaintedItems();
+    QGraphicsItem* LayerItem(Layer layer) const;
 
 private:
     EditorTab* mTab = nullptr;
@@ -169,4 +278,36 @@ private:
     bool mLeftButtonDown = false;
     TransparencySettings mTransparencySettings;
     bool mGridEnabled = false;
+    bool mDraftRendering = false;
+    bool mMinimapRendering = false;
+    QSet<QGraphicsItem*> mDraftPaintedItems;
+    bool mShowCameraLayers = false;
+
+    // The items don't accept Qt's hover events, which would look up what's under the mouse on
+    // every move, the hovered item is picked from the spatial index instead
+    QGraphicsItem* mHoveredItem = nullptr;
+
+    QSet<QGraphicsItem*> mPendingModelSync;
+    QTimer mModelSyncTimer;
+
+    // Every camera, collision and map object is a child of one of these so the opacity and
+    // visibility of a whole layer is a single property change
+    QGraphicsItem* mCameraLayer = nullptr;
+    QGraphicsItem* mCollisionLayer = nullptr;
+    QGraphicsItem* mMapObjectLayer = nullptr;
+
+    BatchedLayerItem* mBatchedCollisions = nullptr;
+    BatchedLayerItem* mBatchedMapObjects = nullptr;
+    bool mBatchedRendering = false;
+    QSet<QGraphicsItem*> mPendingBatchedItems;
+
+    SpatialIndex mSpatialIndex;
+
+    qint64 mCameraImageBudget = 256 * 1024 * 1024;
+    QRectF mCameraImageKeepRect;
+
+    // Kept in step with AddItem/RemoveItem so finding the item for a camera or model object
+    // doesn't have to walk every item in the scene
+    std::map<std::pair<int, int>, CameraGraphicsItem*> mCameraItems;
+    QHash<const MapObject*, ResizeableRectItem*> mMapObjectItems;
 };
@@ -0,0 +1,389 @@
+#include "EditorGraphicsView.hpp"
+#include <QDebug>
+#include <QMenu>
+#include <QMessageBox>
+#include <QMimeData>
+#include <QMouseEvent>
+#include <QUrl>
+#include <algorithm>
+#include "EditorTab.hpp"
+#include "EditorGraphicsScene.hpp"
+#include "CameraManager.hpp"
+#ifdef EDITOR_PAINT_PROFILER
+#include "CameraGraphicsItem.hpp"
+#include "ResizeableArrowItem.hpp"
+#include "ResizeableRectItem.hpp"
+#endif
+
+// How long the view has to be left alone before it's drawn at full quality again
+static const int kDraftRenderingIdleMs = 150;
+
+// Camera images are decoded for where the view will be this far ahead at its current scroll speed
+static const int kPrefetchLookaheadMs = 500;
+
+EditorGraphicsView::EditorGraphicsView(EditorTab* editorTab)
+    : mEditorTab(editorTab)
+{
+    setAcceptDrops(true);
+
+    mDraftRenderingTimer.setSingleShot(true);
+    mDraftRenderingTimer.setInterval(kDraftRenderingIdleMs);
+    connect(&mDraftRenderingTimer, &QTimer::timeout, this, &EditorGraphicsView::EndDraftRendering);
+
+#ifdef EDITOR_PAINT_PROFILER
+    // The overlay is drawn in viewport coordinates so it would be smeared by scrolling and
+    // partial updates, this also makes every frame time a full repaint
+    setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
+#endif
+}
+
+void EditorGraphicsView::BeginDraftRendering()
+{
+    // Every call pushes the full quality repaint back
+    mDraftRenderingTimer.start();
+
+    if (mDraftRendering)
+    {
+        return;
+    }
+
+    mDraftRendering = true;
+    mQualityRenderHints = renderHints();
+    setRenderHints(QPainter::RenderHints());
+    SetSceneDraftRendering(true);
+}
+
+void EditorGraphicsView::EndDraftRendering()
+{
+    if (!mDraftRendering)
+    {
+        return;
+    }
+
+    mDraftRendering = false;
+    SetSceneDraftRendering(false);
+
+    // Stopped moving, only what's on screen has to be kept now
+    mScrollVelocity = QPointF();
+    UpdateCameraImages();
+
+    // Also repaints the whole viewport
+    setRenderHints(mQualityRenderHints);
+}
+
+void EditorGraphicsView::SetSceneDraftRendering(bool draft)
+{
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene)
+    {
+        pScene->SetDraftRendering(draft);
+    }
+}
+
+void EditorGraphicsView::SetCursorShape(Qt::CursorShape shape)
+{
+    if (mCursorShape != shape)
+    {
+        mCursorShape = shape;
+        setCursor(shape);
+    }
+}
+
+void EditorGraphicsView::UpdateCameraImages()
+{
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (!pScene)
+    {
+        return;
+    }
+
+    const QRectF visibleRect = mapToScene(viewport()->rect()).boundingRect();
+    const QRectF aheadRect = visibleRect.translated(mScrollVelocity * kPrefetchLookaheadMs);
+    pScene->UpdateCameraImages(visibleRect.united(aheadRect));
+}
+
+void EditorGraphicsView::mousePressEvent(QMouseEvent* pEvent)
+{
+    if (pEvent->button() != Qt::LeftButton)
+    {
+        // prevent band dragging on other buttons
+        qDebug() << "Ignore non left press";
+        pEvent->ignore();
+        return;
+    }
+
+    qDebug() << "view mouse press (left)";
+    QGraphicsView::mousePressEvent(pEvent);
+}
+
+void EditorGraphicsView::mouseMoveEvent(QMouseEvent* pEvent)
+{
+    // Dragging items or a rubber band around
+    if (pEvent->buttons() & Qt::LeftButton)
+    {
+        BeginDraftRendering();
+    }
+    QGraphicsView::mouseMoveEvent(pEvent);
+}
+
+void EditorGraphicsView::mouseReleaseEvent(QMouseEvent* pEvent)
+{
+    if (pEvent->button() != Qt::LeftButton)
+    {
+        qDebug() << "Ignore non left release";
+        pEvent->ignore();
+        return;
+    }
+
+    qDebug() << "view mouse release (left)";
+    QGraphicsView::mouseReleaseEvent(pEvent);
+}
+
+void EditorGraphicsView::wheelEvent(QWheelEvent* pEvent)
+{
+    if (pEvent->modifiers() == Qt::Modifier::CTRL)
+    {
+        pEvent->ignore();
+        return;
+    }
+    QGraphicsView::wheelEvent(pEvent);
+}
+
+// TODO: implement proper ScrollHandDrag mode.
+// you should be able to move around by pressing and holding the middle mouse button.
+void EditorGraphicsView::keyPressEvent(QKeyEvent* pEvent)
+{
+    if (pEvent->key() == Qt::Key::Key_Shift)
+    {
+        setDragMode(DragMode::ScrollHandDrag);
+        setInteractive(false);
+        pEvent->ignore();
+        return;
+    }
+    QGraphicsView::keyPressEvent(pEvent);
+}
+
+void EditorGraphicsView::keyReleaseEvent(QKeyEvent* pEvent)
+{
+    if (pEvent->key() == Qt::Key::Key_Shift)
+    {
+        setDragMode(DragMode::RubberBandDrag);
+        setInteractive(true);
+        pEvent->ignore();
+        return;
+    }
+    QGraphicsView::keyPressEvent(pEvent);
+}
+
+void EditorGraphicsView::focusOutEvent(QFocusEvent* pEvent)
+{
+    if (pEvent->lostFocus())
+    {
+        // prevents ScrollHandDrag getting "stuck" when losing focus while holding shift
+        setDragMode(DragMode::RubberBandDrag);
+        setInteractive(true);
+    }
+    QGraphicsView::focusOutEvent(pEvent);
+}
+
+void EditorGraphicsView::contextMenuEvent(QContextMenuEvent* pEvent)
+{
+    QMenu menu(this);
+    auto pEditCameraAction = new QAction("Edit camera", &menu);
+    connect(pEditCameraAction, &QAction::triggered, this, [&]()
+        {
+            const QPoint scenePos = mapToScene(pEvent->pos()).toPoint();
+            CameraManager cameraManager(this, mEditorTab, &scenePos);
+            mEditorTab->SetCameraManagerDialog(&cameraManager);
+            cameraManager.exec();
+            mEditorTab->SetCameraManagerDialog(nullptr);
+        });
+    menu.addAction(pEditCameraAction);
+    auto pConnectCollisionsAction = new QAction("Connect collisions", &menu);
+    connect(pConnectCollisionsAction, &QAction::triggered, this, [&]()
+        {
+            mEditorTab->ConnectCollisions();
+        }
+    );
+    menu.addAction(pConnectCollisionsAction);
+    menu.exec(pEvent->globalPos());
+}
+
+void EditorGraphicsView::dragEnterEvent(QDragEnterEvent* pEvent)
+{
+    pEvent->acceptProposedAction();
+}
+
+void EditorGraphicsView::dragMoveEvent(QDragMoveEvent* pEvent)
+{
+    pEvent->acceptProposedAction();
+}
+
+void EditorGraphicsView::dropEvent(QDropEvent* pEvent)
+{
+    // Attempt to load the dropped image
+    QUrl imgUrl = pEvent->mimeData()->urls().first();
+    QPixmap img;
+
+    if (!imgUrl.isLocalFile())
+    {
+        QMessageBox::critical(this, "Error", "Reading from remote file systems is unsupported.");
+        return;
+    }
+
+    if (!img.load(imgUrl.toLocalFile()))
+    {
+        QMessageBox::critical(this, "Error", "The file dropped could not be understood as an image.");
+        return;
+    }
+
+    // Image is valid, continue
+    const QPoint scenePos = mapToScene(pEvent->pos()).toPoint();
+    CameraManager cameraManager(this, mEditorTab, &scenePos);
+    cameraManager.CreateCamera(true, img);
+    pEvent->acceptProposedAction();
+}
+
+void EditorGraphicsView::scrollContentsBy(int dx, int dy)
+{
+    // Hand drag panning, the scroll bars and scrolling with the wheel all end up here
+    BeginDraftRendering();
+    QGraphicsView::scrollContentsBy(dx, dy);
+
+    // The contents moving by dx means the view moved the other way
+    const qreal zoom = transform().m11();
+    const QPointF sceneDelta(-dx / zoom, -dy / zoom);
+    const qint64 elapsedMs = mScrollTimer.isValid() ? mScrollTimer.restart() : -1;
+    if (elapsedMs < 0 || elapsedMs > kDraftRenderingIdleMs)
+    {
+        // First step after being still, there's no speed to go on yet
+        mScrollTimer.start();
+        mScrollVelocity = QPointF();
+    }
+    else
+    {
+        const QPointF stepVelocity = sceneDelta / std::max<qint64>(elapsedMs, 1);
+        mScrollVelocity = (mScrollVelocity + stepVelocity) / 2.0;
+    }
+    UpdateCameraImages();
+}
+
+void EditorGraphicsView::resizeEvent(QResizeEvent* pEvent)
+{
+    QGraphicsView::resizeEvent(pEvent);
+    UpdateCameraImages();
+}
+
+void EditorGraphicsView::leaveEvent(QEvent* pEvent)
+{
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene)
+    {
+        pScene->SetHoveredItem(nullptr);
+    }
+    QGraphicsView::leaveEvent(pEvent);
+}
+
+#ifdef EDITOR_PAINT_PROFILER
+void EditorGraphicsView::paintEvent(QPaintEvent* pEvent)
+{
+    if (mFrameIntervalTimer.isValid())
+    {
+        const qint64 intervalNs = mFrameIntervalTimer.nsecsElapsed();
+        if (intervalNs > 0)
+        {
+            // Smoothed so the number can be read while it's changing
+            const qreal fps = 1000000000.0 / intervalNs;
+            mFps = mFps == 0.0 ? fps : (mFps * 0.9) + (fps * 0.1);
+        }
+    }
+    mFrameIntervalTimer.start();
+
+    // The overlay is part of this frame so it shows the numbers of the one before it
+    PaintProfiler::Stats frameStats;
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    {
+        PaintProfiler::ScopedFrame profiledFrame(frameStats);
+        QGraphicsView::paintEvent(pEvent);
+    }
+    mLastFrameNs = frameTimer.nsecsElapsed();
+
+    mLastFrameStats = frameStats;
+    for (size_t i = 0; i < frameStats.size(); i++)
+    {
+        mTotalStats[i].mPaintCount += frameStats[i].mPaintCount;
+        mTotalStats[i].mPaintNs += frameStats[i].mPaintNs;
+    }
+}
+
+void EditorGraphicsView::drawForeground(QPainter* pPainter, const QRectF& rect)
+{
+    QGraphicsView::drawForeground(pPainter, rect);
+    DrawProfilerOverlay(pPainter);
+}
+
+void EditorGraphicsView::DrawProfilerOverlay(QPainter* pPainter)
+{
+    // Only counted for the overlay so the cost doesn't matter
+    int visibleCameras = 0;
+    int visibleMapObjects = 0;
+    int visibleCollisions = 0;
+    const QRectF visibleRect = mapToScene(viewport()->rect()).boundingRect();
+    for (QGraphicsItem* pItem : scene()->items(visibleRect))
+    {
+        if (pItem->isVisible() && pItem->type() == ResizeableRectItem::Type)
+        {
+            visibleMapObjects++;
+        }
+        else if (pItem->isVisible() && pItem->type() == ResizeableArrowItem::Type)
+        {
+            visibleCollisions++;
+        }
+        else if (pItem->isVisible() && pItem->type() == CameraGraphicsItem::Type)
+        {
+            visibleCameras++;
+        }
+    }
+
+    QStringList lines;
+    lines << QString("Frame %1 ms, %2 fps").arg(mLastFrameNs / 1000000.0, 0, 'f', 2).arg(mFps, 0, 'f', 1);
+    lines << QString("Visible: %1 cameras, %2 map objects, %3 collisions").arg(visibleCameras).arg(visibleMapObjects).arg(visibleCollisions);
+
+    for (size_t i = 0; i < mLastFrameStats.size(); i++)
+    {
+        const auto itemClass = static_cast<PaintProfiler::ItemClass>(i);
+        lines << QString("%1: %2 paints %3 ms, total %4 ms")
+            .arg(PaintProfiler::ItemClassName(itemClass))
+            .arg(mLastFrameStats[i].mPaintCount)
+            .arg(mLastFrameStats[i].mPaintNs / 1000000.0, 0, 'f', 2)
+            .arg(mTotalStats[i].mPaintNs / 1000000.0, 0, 'f', 1);
+    }
+
+    pPainter->save();
+    pPainter->resetTransform();
+    pPainter->setOpacity(1.0);
+
+    const QFontMetrics metrics(pPainter->font());
+    int width = 0;
+    for (const QString& line : lines)
+    {
+        width = std::max(width, metrics.horizontalAdvance(line));
+    }
+    const QRect overlayRect(8, 8, width + 16, (metrics.height() * lines.size()) + 12);
+
+    pPainter->setPen(Qt::NoPen);
+    pPainter->setBrush(QColor(0, 0, 0, 180));
+    pPainter->drawRect(overlayRect);
+
+    pPainter->setPen(Qt::white);
+    int y = overlayRect.top() + 6 + metrics.ascent();
+    for (const QString& line : lines)
+    {
+        pPainter->drawText(overlayRect.left() + 8, y, line);
+        y += metrics.height();
+    }
+
+    pPainter->restore();
+}
+#endif
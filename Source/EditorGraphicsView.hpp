@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QGraphicsView>
+#include <QPainter>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "PaintProfiler.hpp"
+
+class EditorTab;
+
+class EditorGraphicsView final : public QGraphicsView
+{
+public:
+    explicit EditorGraphicsView(EditorTab* editorTab);
+
+    // Drops to fast render hints and no text until the view has been left alone for a moment,
+    // called for anything that repaints a lot in a short time like panning, zooming and dragging
+    void BeginDraftRendering();
+
+    // Only calls setCursor when the shape is different from the last one, items set it on every hover move
+    void SetCursorShape(Qt::CursorShape shape);
+
+protected:
+    void mousePressEvent(QMouseEvent* pEvent) override;
+    void mouseMoveEvent(QMouseEvent* pEvent) override;
+    void mouseReleaseEvent(QMouseEvent* pEvent) override;
+    void wheelEvent(QWheelEvent* pEvent) override;
+    void keyPressEvent(QKeyEvent* pEvent) override;
+    void keyReleaseEvent(QKeyEvent* pEvent) override;
+    void focusOutEvent(QFocusEvent* pEvent) override;
+    void contextMenuEvent(QContextMenuEvent* pEvent) override;
+    void dragEnterEvent(QDragEnterEvent* pEvent) override;
+    void dragMoveEvent(QDragMoveEvent* pEvent) override;
+    void dropEvent(QDropEvent* pEvent) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void resizeEvent(QResizeEvent* pEvent) override;
+    void leaveEvent(QEvent* pEvent) override;
+#ifdef EDITOR_PAINT_PROFILER
+    void paintEvent(QPaintEvent* pEvent) override;
+    void drawForeground(QPainter* pPainter, const QRectF& rect) override;
+#endif
+
+private:
+    void EndDraftRendering();
+    void SetSceneDraftRendering(bool draft);
+
+    // Tells the scene which camera images to decode ahead of time and keep, that's the visible
+    // area stretched out in the direction the view is scrolling
+    void UpdateCameraImages();
+
+    EditorTab* mEditorTab = nullptr;
+
+    QTimer mDraftRenderingTimer;
+    bool mDraftRendering = false;
+    QPainter::RenderHints mQualityRenderHints;
+
+    Qt::CursorShape mCursorShape = Qt::ArrowCursor;
+
+    // Scene units per millisecond, smoothed over the last few scroll steps
+    QPointF mScrollVelocity;
+    QElapsedTimer mScrollTimer;
+
+#ifdef EDITOR_PAINT_PROFILER
+    void DrawProfilerOverlay(QPainter* pPainter);
+
+    qint64 mLastFrameNs = 0;
+    qreal mFps = 0.0;
+    QElapsedTimer mFrameIntervalTimer;
+    PaintProfiler::Stats mLastFrameStats;
+    PaintProfiler::Stats mTotalStats;
+#endif
+};
@@ -10,6 +10,8 @@
 #include <QUuid>
 #include "Model.hpp"
 #include "PathSelectionDialog.hpp"
+#include "PathCache.hpp"
+#include "LvlPatcher.hpp"
 #include "ExportPathDialog.hpp"
 #include "relive_api.hpp"
 #include "EditorGraphicsScene.hpp"
@@ -18,6 +20,9 @@
 #include "qactiongroup.h"
 #include "ReliveApiWrapper.hpp"
 #include "ShowContext.hpp"
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 
 static void FatalError(const char* msg)
 {
@@ -91,6 +96,8 @@ EditorMainWindow::EditorMainWindow(QWidget* aParent)
 
     connect(m_ui->tabWidget, &QTabWidget::tabCloseRequested, this, &EditorMainWindow::onCloseTab);
 
+    // The collision items' ItemCoordinateCache lives in QPixmapCache, the 10 MB default evicts it
+    // all the time on paths with a lot of collisions
     QPixmapCache::setCacheLimit(1024 * 50);
 
     QStringList files;
@@ -138,6 +145,9 @@ void EditorMainWindow::readSettings()
     {
         restoreState(m_Settings.value("windowState").toByteArray());
     }
+
+    m_ui->action_batched_rendering->setChecked(m_Settings.value("batched_rendering", false).toBool());
+    m_ui->action_show_camera_layers->setChecked(m_Settings.value("show_camera_layers", false).toBool());
 }
 
 void EditorMainWindow::setMenuActionsEnabled(bool enable)
@@ -165,186 +175,338 @@ void EditorMainWindow::setMenuActionsEnabled(bool enable)
     }
 }
 
-bool EditorMainWindow::onOpenPath(QString fullFileName, bool createNewPath)
+struct LoadedPath final
+{
+    UP_Model mModel;
+    QString mFileName;
+    bool mIsTempFile = false;
+    bool mIsUpgraded = false;
+    QString mError;
+    QString mContextWarnings;
+};
+using SP_LoadedPath = std::shared_ptr<LoadedPath>;
+
+// Runs on a worker thread so nothing in here can touch the UI, any errors are passed back in the result
+static SP_LoadedPath LoadPath(ReliveAPI::IFileIO& fileIo, const QString& fileName, std::optional<int> pathId, std::optional<int> newPathId, const QString& tempFilePrefix)
 {
-    int newPathId = 0;
-    bool isTempfile = false;
-    bool isUpgraded = false;
-    std::optional<int> selectedPath;
+    auto loaded = std::make_shared<LoadedPath>();
+    loaded->mFileName = fileName;
 
-    EditorFileIO fileIo;
     ReliveAPI::Context context;
+    auto fnOnError = [&](QString err)
+    {
+        loaded->mError = fileName + (pathId ? " path " + QString::number(*pathId) : QString()) + ": " + err;
+    };
 
-    auto fnOpenPath = [&]()
+    auto fnConvertPath = [&]()
     {
-        if (fullFileName.endsWith(".lvl", Qt::CaseInsensitive))
+        if (pathId)
         {
-            // Get the paths in the LVL
-            ReliveAPI::EnumeratePathsResult ret = ReliveAPI::EnumeratePaths(fileIo, fullFileName.toStdString());
-            if (!createNewPath)
-            {
-                // Ask the user to pick one
-                auto pathSelection = new PathSelectionDialog(this, ret);
-                pathSelection->exec();
+            QUuid uuid = QUuid::createUuid();
+            QString tempFileFullPath = QDir::toNativeSeparators(
+                QDir::tempPath() + "/" +
+                tempFilePrefix +
+                "_" +
+                uuid.toString(QUuid::WithoutBraces) + ".json");
 
-                selectedPath = pathSelection->SelectedPath();
-                delete pathSelection;
+            // Convert the binary lvl path to json
+            loaded->mIsTempFile = true;
+            loaded->mFileName = tempFileFullPath;
+            ReliveAPI::ExportPathBinaryToJson(fileIo, tempFileFullPath.toStdString(), fileName.toStdString(), pathId.value(), context);
+        }
+        return true;
+    };
 
-                if (!selectedPath)
-                {
-                    // They didn't pick one
-                    return false;
-                }
+    if (ExecApiCall(fnConvertPath, fnOnError))
+    {
+        if (!context.Ok())
+        {
+            loaded->mContextWarnings = ContextToString(context);
+        }
+
+        try
+        {
+            // Load the json file into the editors object model
+            auto model = std::make_unique<Model>();
+            model->LoadJsonFromFile(loaded->mFileName.toStdString());
+
+            if (model->GetMapInfo().mApiVersion > ReliveAPI::GetApiVersion())
+            {
+                // The json API level is higher than what we support
+                fnOnError("Editor is too old to load this json. Editor API version is " + QString::number(ReliveAPI::GetApiVersion()) + " but json API version is " + QString::number(model->GetMapInfo().mApiVersion));
+                model.reset();
             }
-            else
+            else if (model->GetMapInfo().mApiVersion < ReliveAPI::GetApiVersion())
             {
-                if (ret.paths.empty())
+                // The json API level is lower than what we support - but we can upgrade it
+                std::string upgradedJson;
+                if (ExecApiCall([&]()
+                    {
+                        upgradedJson = ReliveAPI::UpgradePathJson(fileIo, loaded->mFileName.toStdString());
+                        return true;
+                    }, fnOnError))
                 {
-                    // The selected LVL had no path for some reason
-                    QMessageBox::critical(this, "Error", "Selected LVL appears to contain no paths");
-                    return false;
+                    model = std::make_unique<Model>();
+                    model->LoadJsonFromString(upgradedJson);
+                    loaded->mIsUpgraded = true;
                 }
-                // Pick the first path to use as a template for the new path
-                selectedPath = ret.paths[0];
-
-                // And ask the user for the new path id
-                bool ok = false;
-                newPathId = QInputDialog::getInt(this, "Enter new path Id", "Path Id", 0, 0, 99, 1, &ok);
-                if (!ok)
+                else
                 {
-                    // User bailed on picking a path id
-                    return false;
+                    model.reset();
                 }
             }
 
-            QUuid uuid = QUuid::createUuid();
-            QString tempFileFullPath = QDir::toNativeSeparators(
-                QDir::tempPath() + "/" +
-                qApp->applicationName().replace(" ", "") +
-                "_" +
-                uuid.toString(QUuid::WithoutBraces) + ".json");
-
-            // Convert the binary lvl path to json
-            ReliveAPI::ExportPathBinaryToJson(fileIo, tempFileFullPath.toStdString(), fullFileName.toStdString(), selectedPath.value(), context);
+            // The path selection dialog shows it next time the LVL is opened
+            if (model && pathId && !newPathId)
+            {
+                CachePathThumbnail(*model, PathThumbnailKey(fileName, model->GetMapInfo().mPathBnd), *pathId);
+            }
 
-            isTempfile = true;
+            if (model && newPathId)
+            {
+                model->CreateAsNewPath(*newPathId);
+            }
 
-            // And continue to load the newly saved json file
-            fullFileName = tempFileFullPath;
+            loaded->mModel = std::move(model);
         }
-        return true;
-    };
+        catch (const JsonKeyNotFoundException& e)
+        {
+            fnOnError(QString("Key missing from json: ") + e.Key().c_str());
+        }
+        catch (const ModelException&)
+        {
+            fnOnError("Failed to load json");
+        }
+    }
 
-    auto fnOnError = [&](QString err)
+    // If exported to a temp file then delete it now we've loaded it to memory
+    if (loaded->mIsTempFile)
     {
-        QMessageBox::critical(this, "Error", err);
-    };
+        QFile::remove(loaded->mFileName);
 
-    if (!ExecApiCall(fnOpenPath, fnOnError))
-    {
-        return false;
+        if (loaded->mModel)
+        {
+            // Also change the file name to something more sane and force SaveAs if the user
+            // attempts to save this path.
+            const auto generatedName = loaded->mModel->GetMapInfo().mGame + "_" + loaded->mModel->GetMapInfo().mPathBnd + "_" + QString::number(*pathId).toStdString();
+            loaded->mFileName = QString(generatedName.c_str());
+        }
     }
 
-    if (!context.Ok())
+    if (!loaded->mModel)
     {
-        ShowContext(context);
+        loaded->mError = loaded->mError.isEmpty() ? fileName + ": Failed to load path" : loaded->mError;
     }
 
-    // First check if we already have this json file open
-    for (int i = 0; i < m_ui->tabWidget->count(); i++)
+    return loaded;
+}
+
+void EditorMainWindow::onOpenPath(QString fullFileName, bool createNewPath)
+{
+    std::optional<int> newPathId;
+    std::vector<std::optional<int>> pathIds;
+
+    if (!fullFileName.endsWith(".lvl", Qt::CaseInsensitive))
     {
-        auto pTab = static_cast<EditorTab*>(m_ui->tabWidget->widget(i));
-        // TODO: Probably need to normalize slashes in here, C:\foo.txt vs C:/foo.txt
-        // could get past this check.
-        if (pTab->GetJsonFileName().compare(fullFileName, Qt::CaseInsensitive) == 0)
+        // First check if we already have this json file open
+        for (int i = 0; i < m_ui->tabWidget->count(); i++)
         {
-            // Set focus to the tab
-            m_ui->tabWidget->setCurrentIndex(i);
-            return true;
+            auto pTab = static_cast<EditorTab*>(m_ui->tabWidget->widget(i));
+            // TODO: Probably need to normalize slashes in here, C:\foo.txt vs C:/foo.txt
+            // could get past this check.
+            if (pTab->GetJsonFileName().compare(fullFileName, Qt::CaseInsensitive) == 0)
+            {
+                // Set focus to the tab
+                m_ui->tabWidget->setCurrentIndex(i);
+                RememberOpenDir(fullFileName);
+                return;
+            }
         }
+
+        // A json file is just the one path and there is no LVL to cache
+        pathIds.push_back(std::nullopt);
+        LoadPathsAsync(std::make_shared<EditorFileIO>(), fullFileName, pathIds, newPathId);
+        return;
     }
 
-    try
+    // An export that patched this LVL might have been interrupted, it has to be rolled back before anything reads it
+    QString recoveryError;
+    if (!RecoverInterruptedLvlPatch(fullFileName, recoveryError))
     {
-        // Load the json file into the editors object model
-        auto model = std::make_unique<Model>();
-        model->LoadJsonFromFile(fullFileName.toStdString());
+        QMessageBox::critical(this, "Error", recoveryError);
+        return;
+    }
 
-        if (model->GetMapInfo().mApiVersion > ReliveAPI::GetApiVersion())
-        {
-            // The json API level is higher than what we support
-            QMessageBox::critical(this, "Error", "Editor is too old to load this json. Editor API version is " + QString::number(ReliveAPI::GetApiVersion()) + " but json API version is " + QString::number(model->GetMapInfo().mApiVersion));
-            return false;
-        }
-        else if (model->GetMapInfo().mApiVersion < ReliveAPI::GetApiVersion())
+    auto fnSelectPaths = [&]()
+    {
+        // Get the paths in the LVL
+        EditorFileIO fileIo;
+        ReliveAPI::EnumeratePathsResult ret = EnumeratePathsCached(fileIo, fullFileName);
+        if (!createNewPath)
         {
-            // The json API level is lower than what we support - but we can upgrade it
-            std::string upgradedJson = ReliveAPI::UpgradePathJson(fileIo, fullFileName.toStdString());
+            // Ask the user to pick some
+            auto pathSelection = new PathSelectionDialog(this, ret, fullFileName);
+            pathSelection->exec();
+
+            for (int pathId : pathSelection->SelectedPaths())
             {
-                /*
-                QString filename = "upgrade_test.json";
-                QFile file(filename);
-                if (file.open(QIODevice::ReadWrite)) 
-                {
-                    QTextStream stream(&file);
-                    stream << upgradedJson.c_str() << endl;
-                }*/
+                pathIds.push_back(pathId);
             }
-            model = std::make_unique<Model>();
-            model->LoadJsonFromString(upgradedJson);
-            isUpgraded = true;
+            delete pathSelection;
+
+            // Empty if they didn't pick any
+            return !pathIds.empty();
         }
 
-        if (createNewPath)
+        if (ret.paths.empty())
         {
-            model->CreateAsNewPath(newPathId);
+            // The selected LVL had no path for some reason
+            QMessageBox::critical(this, "Error", "Selected LVL appears to contain no paths");
+            return false;
         }
+        // Pick the first path to use as a template for the new path
+        pathIds.push_back(ret.paths[0]);
 
-        // If exported to a temp file then delete it now we've loaded it to memory
-        if (isTempfile)
-        {
-            QFile::remove(fullFileName);
+        // And ask the user for the new path id
+        bool ok = false;
+        newPathId = QInputDialog::getInt(this, "Enter new path Id", "Path Id", 0, 0, 99, 1, &ok);
 
-            // Also change the file name to something more sane and force SaveAs if the user
-            // attempts to save this path.
-            const auto generatedName = model->GetMapInfo().mGame + "_" + model->GetMapInfo().mPathBnd + "_" + QString::number(*selectedPath).toStdString();
-            fullFileName = QString(generatedName.c_str());
-        }
+        // False if user bailed on picking a path id
+        return ok;
+    };
 
-        EditorTab* view = new EditorTab(m_ui->tabWidget, std::move(model), fullFileName, isTempfile, statusBar(), mSnapSettings);
+    auto fnOnError = [&](QString err)
+    {
+        QMessageBox::critical(this, "Error", err);
+    };
 
-        connect(
-            view, &EditorTab::CleanChanged,
-            this, &EditorMainWindow::UpdateWindowTitle
-        );
+    if (!ExecApiCall(fnSelectPaths, fnOnError))
+    {
+        return;
+    }
+
+    // Every path in the batch reads the same LVL so only load it from the disk once, a single
+    // path only reads its own parts of it so isn't worth holding the whole LVL in memory for
+    std::shared_ptr<ReliveAPI::IFileIO> fileIo;
+    if (pathIds.size() > 1)
+    {
+        fileIo = std::make_shared<CachedLvlFileIO>(fullFileName.toStdString());
+    }
+    else
+    {
+        fileIo = std::make_shared<EditorFileIO>();
+    }
+    LoadPathsAsync(fileIo, fullFileName, pathIds, newPathId);
+}
 
-        QFileInfo fileInfo(fullFileName);
-        const int tabIdx = m_ui->tabWidget->addTab(view, fileInfo.fileName());
-        m_ui->tabWidget->setTabToolTip(tabIdx, fullFileName);
-        m_ui->tabWidget->setTabIcon(tabIdx, QIcon(":/icons/rsc/icons/Well.png"));
-        m_ui->tabWidget->setCurrentIndex(tabIdx);
+void EditorMainWindow::LoadPathsAsync(std::shared_ptr<ReliveAPI::IFileIO> fileIo, QString fullFileName, const std::vector<std::optional<int>>& pathIds, std::optional<int> newPathId)
+{
+    // Shared by every path in the batch, the last one to finish reports everything that went wrong
+    struct Batch final
+    {
+        int mRemaining = 0;
+        bool mAnyLoaded = false;
+        QStringList mErrors;
+        QString mContextWarnings;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->mRemaining = static_cast<int>(pathIds.size());
 
-        m_ui->stackedWidget->setCurrentIndex(1);
+    auto progress = new QProgressDialog("Loading " + QFileInfo(fullFileName).fileName() + "...", QString(), 0, batch->mRemaining, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setValue(0);
 
-        view->UpdateTabTitle(view->IsClean());
-        if (isUpgraded)
-        {
-            view->Save();
-        }
-        setMenuActionsEnabled(true);
+    const QString tempFilePrefix = qApp->applicationName().replace(" ", "");
 
-        return true;
-    }
-    catch (const JsonKeyNotFoundException& e)
+    for (const auto& pathId : pathIds)
     {
-        QMessageBox::critical(this, "Error", QString("Key missing from json: ") + e.Key().c_str());
-        return false;
+        auto watcher = new QFutureWatcher<SP_LoadedPath>(this);
+        connect(watcher, &QFutureWatcher<SP_LoadedPath>::finished, this, [=]()
+            {
+                SP_LoadedPath loaded = watcher->result();
+                watcher->deleteLater();
+
+                // Each tab appears as soon as its path is ready
+                if (loaded->mModel)
+                {
+                    AddPathTab(std::move(loaded->mModel), loaded->mFileName, loaded->mIsTempFile, loaded->mIsUpgraded);
+                    batch->mAnyLoaded = true;
+                }
+                else
+                {
+                    batch->mErrors.append(loaded->mError);
+                }
+                batch->mContextWarnings += loaded->mContextWarnings;
+
+                progress->setValue(progress->value() + 1);
+
+                batch->mRemaining--;
+                if (batch->mRemaining == 0)
+                {
+                    progress->deleteLater();
+
+                    // Only worth starting from next time if something in it actually opened
+                    if (batch->mAnyLoaded)
+                    {
+                        RememberOpenDir(fullFileName);
+                    }
+
+                    if (!batch->mErrors.isEmpty())
+                    {
+                        QMessageBox::critical(this, "Error", batch->mErrors.join("\n"));
+                    }
+
+                    if (!batch->mContextWarnings.isEmpty())
+                    {
+                        QMessageBox::warning(this, "Context warnings", batch->mContextWarnings);
+                    }
+                }
+            });
+
+        watcher->setFuture(QtConcurrent::run([=]()
+            {
+                return LoadPath(*fileIo, fullFileName, pathId, newPathId, tempFilePrefix);
+            }));
     }
-    catch (const ModelException&)
+}
+
+void EditorMainWindow::RememberOpenDir(const QString& fullFileName)
+{
+    QFileInfo info(fullFileName);
+    m_Settings.setValue("last_open_dir", info.dir().path());
+}
+
+void EditorMainWindow::AddPathTab(UP_Model model, QString fullFileName, bool isTempFile, bool isUpgraded)
+{
+    EditorTab* view = new EditorTab(m_ui->tabWidget, std::move(model), fullFileName, isTempFile, statusBar(), mSnapSettings);
+
+    connect(
+        view, &EditorTab::CleanChanged,
+        this, &EditorMainWindow::UpdateWindowTitle
+    );
+
+    QFileInfo fileInfo(fullFileName);
+    const int tabIdx = m_ui->tabWidget->addTab(view, fileInfo.fileName());
+    m_ui->tabWidget->setTabToolTip(tabIdx, fullFileName);
+    m_ui->tabWidget->setTabIcon(tabIdx, QIcon(":/icons/rsc/icons/Well.png"));
+    m_ui->tabWidget->setCurrentIndex(tabIdx);
+
+    m_ui->stackedWidget->setCurrentIndex(1);
+
+    view->GetScene().SetBatchedRendering(m_ui->action_batched_rendering->isChecked());
+    view->GetScene().SetShowCameraLayers(m_ui->action_show_camera_layers->isChecked());
+    view->GetScene().SetCameraImageBudget(CameraImageBudgetBytes());
+    view->GetScene().SetLayerVisible(EditorGraphicsScene::Layer::Cameras, m_ui->action_toggle_show_screens->isChecked());
+    view->GetScene().SetLayerVisible(EditorGraphicsScene::Layer::Collisions, m_ui->action_toggle_show_collision_items->isChecked());
+    view->GetScene().SetLayerVisible(EditorGraphicsScene::Layer::MapObjects, m_ui->action_toggle_show_map_objects->isChecked());
+
+    view->UpdateTabTitle(view->IsClean());
+    if (isUpgraded)
     {
-        QMessageBox::critical(this, "Error", "Failed to load json");
-        return false;
+        view->Save();
     }
+    setMenuActionsEnabled(true);
 }
 
 void EditorMainWindow::onCloseTab(int index)
@@ -446,11 +608,7 @@ void EditorMainWindow::on_action_open_path_triggered()
     QString fileName = QFileDialog::getOpenFileName(this, tr("Open level"), lastOpenDir, tr("Supported Files (*.json *.lvl);; Json Files (*.json);;Level Files (*.lvl);;All Files (*)"));
     if (!fileName.isEmpty())
     {
-        if (onOpenPath(fileName, false))
-        {
-            QFileInfo info(fileName);
-            m_Settings.setValue("last_open_dir", info.dir().path());
-        }
+        onOpenPath(fileName, false);
     }
 }
 
@@ -703,11 +861,7 @@ void EditorMainWindow::on_actionNew_path_triggered()
     QString fileName = QFileDialog::getOpenFileName(this, tr("Open lvl (as template for new path)"), lastOpenDir, tr("Level Files (*.lvl);;All Files (*)"));
     if (!fileName.isEmpty())
     {
-        if (onOpenPath(fileName, true))
-        {
-            QFileInfo info(fileName);
-            m_Settings.setValue("last_open_dir", info.dir().path());
-        }
+        onOpenPath(fileName, true);
     }
 }
 
@@ -836,3 +990,65 @@ void EditorMainWindow::on_action_snap_map_objects_y_toggled(bool on)
 {
     mSnapSettings.MapObjectSnapping().mSnapY = on;
 }
+
+void EditorMainWindow::on_action_batched_rendering_toggled(bool on)
+{
+    m_Settings.setValue("batched_rendering", on);
+    for (int i = 0; i < m_ui->tabWidget->count(); i++)
+    {
+        static_cast<EditorTab*>(m_ui->tabWidget->widget(i))->GetScene().SetBatchedRendering(on);
+    }
+}
+
+void EditorMainWindow::on_action_show_camera_layers_toggled(bool on)
+{
+    m_Settings.setValue("show_camera_layers", on);
+    for (int i = 0; i < m_ui->tabWidget->count(); i++)
+    {
+        static_cast<EditorTab*>(m_ui->tabWidget->widget(i))->GetScene().SetShowCameraLayers(on);
+    }
+}
+
+void EditorMainWindow::on_action_camera_image_budget_triggered()
+{
+    bool ok = false;
+    const int budgetMb = QInputDialog::getInt(this, "Camera image memory budget", "Megabytes per path", m_Settings.value("camera_image_budget_mb", 256).toInt(), 16, 8192, 16, &ok);
+    if (!ok)
+    {
+        return;
+    }
+
+    m_Settings.setValue("camera_image_budget_mb", budgetMb);
+    for (int i = 0; i < m_ui->tabWidget->count(); i++)
+    {
+        static_cast<EditorTab*>(m_ui->tabWidget->widget(i))->GetScene().SetCameraImageBudget(CameraImageBudgetBytes());
+    }
+}
+
+qint64 EditorMainWindow::CameraImageBudgetBytes()
+{
+    return m_Settings.value("camera_image_budget_mb", 256).toLongLong() * 1024 * 1024;
+}
+
+void EditorMainWindow::on_action_toggle_show_screens_toggled(bool on)
+{
+    SetLayerVisibleInAllTabs(EditorGraphicsScene::Layer::Cameras, on);
+}
+
+void EditorMainWindow::on_action_toggle_show_collision_items_toggled(bool on)
+{
+    SetLayerVisibleInAllTabs(EditorGraphicsScene::Layer::Collisions, on);
+}
+
+void EditorMainWindow::on_action_toggle_show_map_objects_toggled(bool on)
+{
+    SetLayerVisibleInAllTabs(EditorGraphicsScene::Layer::MapObjects, on);
+}
+
+void EditorMainWindow::SetLayerVisibleInAllTabs(EditorGraphicsScene::Layer layer, bool visible)
+{
+    for (int i = 0; i < m_ui->tabWidget->count(); i++)
+    {
+        static_cast<EditorTab*>(m_ui->tabWidget->widget(i))->GetScene().SetLayerVisible(layer, visible);
+    }
+}
@@ -2,16 +2,24 @@
 
 #include <QMainWindow>
 #include <memory>
+#include <optional>
+#include <vector>
 #include <QSettings>
 #include "EditorTab.hpp"
 #include "ClipBoard.hpp"
 #include "SnapSettings.hpp"
+#include "ObjectIconAtlas.hpp"
 
 namespace Ui
 {
     class EditorMainWindow;
 }
 
+namespace ReliveAPI
+{
+    class IFileIO;
+}
+
 class EditorMainWindow final : public QMainWindow
 {
     Q_OBJECT
@@ -90,14 +98,33 @@ private slots:
 
     void on_action_snap_map_objects_y_toggled(bool on);
 
+    void on_action_batched_rendering_toggled(bool on);
+
+    void on_action_show_camera_layers_toggled(bool on);
+
+    void on_action_camera_image_budget_triggered();
+
+    void on_action_toggle_show_screens_toggled(bool on);
+
+    void on_action_toggle_show_collision_items_toggled(bool on);
+
+    void on_action_toggle_show_map_objects_toggled(bool on);
+
 private:
     void readSettings();
+    void SetLayerVisibleInAllTabs(EditorGraphicsScene::Layer layer, bool visible);
+    qint64 CameraImageBudgetBytes();
     void setMenuActionsEnabled(bool enable);
-    bool onOpenPath(QString fileName, bool createNewPath);
+    void onOpenPath(QString fileName, bool createNewPath);
+    void LoadPathsAsync(std::shared_ptr<ReliveAPI::IFileIO> fileIo, QString fullFileName, const std::vector<std::optional<int>>& pathIds, std::optional<int> newPathId);
+    void AddPathTab(UP_Model model, QString fullFileName, bool isTempFile, bool isUpgraded);
     void UpdateWindowTitle();
+    void RememberOpenDir(const QString& fullFileName);
     void DisconnectTabSignals();
     void closeEvent(QCloseEvent* pEvent) override;
 private:
+    // Packed before any tab exists and freed before the QApplication is
+    ObjectIconAtlas mObjectIconAtlas;
     Ui::EditorMainWindow* m_ui;
     QSettings m_Settings;
     ClipBoard mClipBoard;
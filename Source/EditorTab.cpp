@@ -12,15 +12,19 @@
 #include <QMenu>
 #include <QStatusBar>
 #include <QFileDialog>
+#include <QElapsedTimer>
+#include <algorithm>
 #include "ResizeableArrowItem.hpp"
 #include "ResizeableRectItem.hpp"
 #include "CameraGraphicsItem.hpp"
 #include "EditorGraphicsScene.hpp"
+#include "EditorGraphicsView.hpp"
+#include "MinimapWidget.hpp"
 #include "BigSpinBox.hpp"
 #include <QLineEdit>
-#include "PropertyTreeItemBase.hpp"
 #include "StringProperty.hpp"
 #include "PropertyTreeWidget.hpp"
+#include "PropertyModel.hpp"
 #include <QFileInfo>
 #include "BasicTypeProperty.hpp"
 #include "EnumProperty.hpp"
@@ -48,6 +52,9 @@ const float KZoomFactor = 0.10f;
 const float KMaxZoomOutLevels = 6.0f;
 const float KMaxZoomInLevels = 14.0f;
 
+// How long a batch of creating graphics items for the cells off screen can take before giving the event loop a turn
+const int kPopulateBatchMs = 10;
+
 INITIALIZE_EASYLOGGINGPP
 
 class SetSelectionCommand final : public QUndoCommand
@@ -187,151 +194,6 @@ private:
     bool mFirst = false;
 };
 
-class EditorGraphicsView final : public QGraphicsView
-{
-public:
-    EditorGraphicsView(EditorTab* editorTab)
-        : mEditorTab(editorTab)
-    {
-        setAcceptDrops(true);
-    }
-
-    void mousePressEvent(QMouseEvent* pEvent) override
-    {
-        if (pEvent->button() != Qt::LeftButton)
-        {
-            // prevent band dragging on other buttons
-            qDebug() << "Ignore non left press";
-            pEvent->ignore();
-            return;
-        }
-
-        qDebug() << "view mouse press (left)";
-        QGraphicsView::mousePressEvent(pEvent);
-    }
-
-    void mouseReleaseEvent(QMouseEvent* pEvent) override
-    {
-        if (pEvent->button() != Qt::LeftButton)
-        {
-            qDebug() << "Ignore non left release";
-            pEvent->ignore();
-            return;
-        }
-
-        qDebug() << "view mouse release (left)";
-        QGraphicsView::mouseReleaseEvent(pEvent);
-    }
-
-    void wheelEvent(QWheelEvent* pEvent) override
-    {
-        if (pEvent->modifiers() == Qt::Modifier::CTRL)
-        {
-            pEvent->ignore();
-            return;
-        }
-        QGraphicsView::wheelEvent(pEvent);
-    }
-
-    // TODO: implement proper ScrollHandDrag mode.
-    // you should be able to move around by pressing and holding the middle mouse button.
-    void keyPressEvent(QKeyEvent* pEvent) override
-    {
-        if (pEvent->key() == Qt::Key::Key_Shift)
-        {
-            setDragMode(DragMode::ScrollHandDrag);
-            setInteractive(false);
-            pEvent->ignore();
-            return;
-        }
-        QGraphicsView::keyPressEvent(pEvent);
-    }
-
-    void keyReleaseEvent(QKeyEvent* pEvent) override
-    {
-        if (pEvent->key() == Qt::Key::Key_Shift)
-        {
-            setDragMode(DragMode::RubberBandDrag);
-            setInteractive(true);
-            pEvent->ignore();
-            return;
-        }
-        QGraphicsView::keyPressEvent(pEvent);
-    }
-
-    void focusOutEvent(QFocusEvent* pEvent) override
-    {
-        if (pEvent->lostFocus())
-        {
-            // prevents ScrollHandDrag getting "stuck" when losing focus while holding shift
-            setDragMode(DragMode::RubberBandDrag);
-            setInteractive(true);
-        }
-        QGraphicsView::focusOutEvent(pEvent);
-    }
-
-    void contextMenuEvent(QContextMenuEvent* pEvent) override
-    {
-        QMenu menu(this);
-        auto pEditCameraAction = new QAction("Edit camera", &menu);
-        connect(pEditCameraAction, &QAction::triggered, this, [&]()
-            {
-                const QPoint scenePos = mapToScene(pEvent->pos()).toPoint();
-                CameraManager cameraManager(this, mEditorTab, &scenePos);
-                mEditorTab->SetCameraManagerDialog(&cameraManager);
-                cameraManager.exec();
-                mEditorTab->SetCameraManagerDialog(nullptr);
-            });
-        menu.addAction(pEditCameraAction);
-        auto pConnectCollisionsAction = new QAction("Connect collisions", &menu);
-        connect(pConnectCollisionsAction, &QAction::triggered, this, [&]()
-            {
-                mEditorTab->ConnectCollisions();
-            }
-        );
-        menu.addAction(pConnectCollisionsAction);
-        menu.exec(pEvent->globalPos());
-    }
-
-    void dragEnterEvent(QDragEnterEvent* pEvent) override
-    {
-        pEvent->acceptProposedAction();
-    }
-
-    void dragMoveEvent(QDragMoveEvent* pEvent) override
-    {
-        pEvent->acceptProposedAction();
-    }
-
-    void dropEvent(QDropEvent* pEvent) override
-    {
-        // Attempt to load the dropped image
-        QUrl imgUrl = pEvent->mimeData()->urls().first();
-        QPixmap img;
-
-        if (!imgUrl.isLocalFile())
-        {
-            QMessageBox::critical(this, "Error", "Reading from remote file systems is unsupported.");
-            return;
-        }
-
-        if (!img.load(imgUrl.toLocalFile()))
-        {
-            QMessageBox::critical(this, "Error", "The file dropped could not be understood as an image.");
-            return;
-        }
-
-        // Image is valid, continue
-        const QPoint scenePos = mapToScene(pEvent->pos()).toPoint();
-        CameraManager cameraManager(this, mEditorTab, &scenePos);
-        cameraManager.CreateCamera(true, img);
-        pEvent->acceptProposedAction();
-    }
-
-private:
-    EditorTab* mEditorTab = nullptr;
-};
-
 
 EditorTab::EditorTab(QTabWidget* aParent, UP_Model model, QString jsonFileName, bool isTempFile, QStatusBar* pStatusBar, SnapSettings& snapSettings)
     : QMainWindow(aParent),
@@ -392,31 +254,46 @@ EditorTab::EditorTab(QTabWidget* aParent, UP_Model model, QString jsonFileName,
 
     const MapInfo& mapInfo = mModel->GetMapInfo();
 
+    // Nothing gets a graphics item yet, PopulateItemsBatch does the cells around the viewport
+    // first and then the rest a batch at a time
     for (int x = 0; x < mapInfo.mXSize; x++)
     {
         for (int y = 0; y < mapInfo.mYSize; y++)
         {
-            Camera* pCam = mModel->CameraAt(x, y);
-            auto pCameraGraphicsItem = MakeCameraGraphicsItem(pCam, mapInfo.mXGridSize * x, y *  mapInfo.mYGridSize, mapInfo.mXGridSize, mapInfo.mYGridSize);
-            mScene->addItem(pCameraGraphicsItem);
-
-            if (pCam)
+            UnpopulatedCell cell;
+            cell.mX = x;
+            cell.mY = y;
+            cell.mCamera = mModel->CameraAt(x, y);
+            if (cell.mCamera)
             {
-                for (auto& mapObj : pCam->mMapObjects)
+                for (auto& mapObj : cell.mCamera->mMapObjects)
                 {
-                    auto pMapObject = MakeResizeableRectItem(mapObj.get());
-                    mScene->addItem(pMapObject);
+                    cell.mMapObjects.push_back(mapObj.get());
                 }
             }
+            mUnpopulatedCells.push_back(std::move(cell));
         }
     }
 
+    // Collisions go with the cell their middle is in
     for (auto& collision : mModel->CollisionItems())
     {
-        auto pLine = MakeResizeableArrowItem(collision.get());
-        mScene->addItem(pLine);
+        if (mUnpopulatedCells.empty())
+        {
+            mScene->AddItem(MakeResizeableArrowItem(collision.get()));
+            continue;
+        }
+
+        const int cellX = std::clamp(((collision->X1() + collision->X2()) / 2) / mapInfo.mXGridSize, 0, mapInfo.mXSize - 1);
+        const int cellY = std::clamp(((collision->Y1() + collision->Y2()) / 2) / mapInfo.mYGridSize, 0, mapInfo.mYSize - 1);
+        mUnpopulatedCells[(cellX * mapInfo.mYSize) + cellY].mCollisions.push_back(collision.get());
     }
 
+    mPopulateTimer.setSingleShot(true);
+    mPopulateTimer.setInterval(0);
+    connect(&mPopulateTimer, &QTimer::timeout, this, &EditorTab::PopulateItemsBatch);
+    mPopulateTimer.start();
+
     mScene->UpdateSceneRect();
 
     ui->graphicsView->setScene(mScene.get());
@@ -429,6 +306,13 @@ EditorTab::EditorTab(QTabWidget* aParent, UP_Model model, QString jsonFileName,
     addDockWidget(Qt::RightDockWidgetArea, ui->propertyDockWidget);
     addDockWidget(Qt::RightDockWidgetArea, ui->undoHistoryDockWidget);
 
+    // Jumping around the path from here is a lot cheaper than zooming all the way out and back in
+    auto pMinimapDockWidget = new QDockWidget("Minimap", this);
+    pMinimapDockWidget->setFeatures(QDockWidget::DockWidgetMovable);
+    pMinimapDockWidget->setContextMenuPolicy(Qt::PreventContextMenu);
+    pMinimapDockWidget->setWidget(new MinimapWidget(mScene.get(), ui->graphicsView, pMinimapDockWidget));
+    addDockWidget(Qt::RightDockWidgetArea, pMinimapDockWidget);
+
     ui->propertyDockWidget->setMinimumWidth(310);
 
     setContextMenuPolicy(Qt::PreventContextMenu);
@@ -436,27 +320,94 @@ EditorTab::EditorTab(QTabWidget* aParent, UP_Model model, QString jsonFileName,
     connect(&mUndoStack , &QUndoStack::cleanChanged, this, &EditorTab::UpdateTabTitle);
 }
 
+void EditorTab::PopulateAllItems()
+{
+    mPopulateTimer.stop();
+    for (const UnpopulatedCell& cell : mUnpopulatedCells)
+    {
+        PopulateCell(cell);
+    }
+    mUnpopulatedCells.clear();
+}
+
+QRectF EditorTab::CellRect(const UnpopulatedCell& cell) const
+{
+    const MapInfo& mapInfo = mModel->GetMapInfo();
+    return QRectF(cell.mX * mapInfo.mXGridSize, cell.mY * mapInfo.mYGridSize, mapInfo.mXGridSize, mapInfo.mYGridSize);
+}
+
+void EditorTab::PopulateItemsBatch()
+{
+    const QRectF visibleRect = ui->graphicsView->mapToScene(ui->graphicsView->viewport()->rect()).boundingRect();
+    const QPointF viewCentre = visibleRect.center();
+
+    // Sorted every batch so that scrolling somewhere else moves that area to the front. Nearest
+    // to the middle of the view go last so they can be taken off the back.
+    std::sort(mUnpopulatedCells.begin(), mUnpopulatedCells.end(), [&](const UnpopulatedCell& a, const UnpopulatedCell& b)
+    {
+        const QPointF aDelta = CellRect(a).center() - viewCentre;
+        const QPointF bDelta = CellRect(b).center() - viewCentre;
+        return QPointF::dotProduct(aDelta, aDelta) > QPointF::dotProduct(bDelta, bDelta);
+    });
+
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    while (!mUnpopulatedCells.empty())
+    {
+        // Whatever is on screen is always done now, the rest only while this batch has time left
+        if (batchTimer.elapsed() >= kPopulateBatchMs && !CellRect(mUnpopulatedCells.back()).intersects(visibleRect))
+        {
+            break;
+        }
+
+        PopulateCell(mUnpopulatedCells.back());
+        mUnpopulatedCells.pop_back();
+    }
+
+    if (!mUnpopulatedCells.empty())
+    {
+        mPopulateTimer.start();
+    }
+}
+
+void EditorTab::PopulateCell(const UnpopulatedCell& cell)
+{
+    const MapInfo& mapInfo = mModel->GetMapInfo();
+    mScene->AddItem(MakeCameraGraphicsItem(cell.mCamera, mapInfo.mXGridSize * cell.mX, cell.mY * mapInfo.mYGridSize, mapInfo.mXGridSize, mapInfo.mYGridSize));
+
+    for (MapObject* pMapObject : cell.mMapObjects)
+    {
+        mScene->AddItem(MakeResizeableRectItem(pMapObject));
+    }
+
+    for (CollisionObject* pCollision : cell.mCollisions)
+    {
+        mScene->AddItem(MakeResizeableArrowItem(pCollision));
+    }
+}
+
 ResizeableRectItem* EditorTab::MakeResizeableRectItem(MapObject* pMapObject)
 {
-    return new ResizeableRectItem(ui->graphicsView, pMapObject, *static_cast<PropertyTreeWidget*>(ui->treeWidget), mScene->GetTransparencySettings().MapObjectTransparency(), mSnapSettings, *this);
+    return new ResizeableRectItem(ui->graphicsView, pMapObject, *static_cast<PropertyTreeWidget*>(ui->treeWidget), mSnapSettings, *this);
 }
 
 ResizeableArrowItem* EditorTab::MakeResizeableArrowItem(CollisionObject* pCollisionObject)
 {
-    return new ResizeableArrowItem(ui->graphicsView, pCollisionObject, *static_cast<PropertyTreeWidget*>(ui->treeWidget), mScene->GetTransparencySettings().CollisionTransparency(), mSnapSettings, *this);
+    return new ResizeableArrowItem(ui->graphicsView, pCollisionObject, *static_cast<PropertyTreeWidget*>(ui->treeWidget), mSnapSettings, *this);
 }
 
 CameraGraphicsItem* EditorTab::MakeCameraGraphicsItem(Camera* pCamera, int x, int y, int w, int h)
 {
-    return new CameraGraphicsItem(pCamera, x, y, w, h, mScene->GetTransparencySettings().CameraTransparency());
+    return new CameraGraphicsItem(pCamera, x, y, w, h);
 }
 
 void EditorTab::SyncPropertyEditor()
 {
+    // More than one item shows the properties they have in common and edits them all at once
     auto selected = mScene->selectedItems();
-    if (selected.count() == 1)
+    if (!selected.isEmpty())
     {
-        PopulatePropertyEditor(selected[0]);
+        PopulatePropertyEditor(selected);
     }
     else
     {
@@ -539,15 +490,12 @@ void EditorTab::wheelEvent(QWheelEvent* pEvent)
     QWidget::wheelEvent(pEvent);
 }
 
-// TODO: zoom doesn't work properly without ui->graphicsView->resetTransform().
-// figure out why and if there's a better way.
 void EditorTab::ZoomIn()
 {
     if (iZoomLevel < 1.0f + (KZoomFactor*KMaxZoomInLevels))
     {
         iZoomLevel += KZoomFactor;
-        ui->graphicsView->resetTransform();
-        ui->graphicsView->setTransform(QTransform::fromScale(iZoomLevel, iZoomLevel), true);
+        ApplyZoom();
     }
 }
 
@@ -556,16 +504,23 @@ void EditorTab::ZoomOut()
     if (iZoomLevel > 1.0f - (KZoomFactor*KMaxZoomOutLevels))
     {
         iZoomLevel -= KZoomFactor;
-        ui->graphicsView->resetTransform();
-        ui->graphicsView->setTransform(QTransform::fromScale(iZoomLevel, iZoomLevel), true);
+        ApplyZoom();
     }
 }
 
 void EditorTab::ResetZoom()
 {
     iZoomLevel = 1.0f;
-    ui->graphicsView->resetTransform();
-    ui->graphicsView->setTransform(QTransform::fromScale(iZoomLevel, iZoomLevel), true);
+    ApplyZoom();
+}
+
+void EditorTab::ApplyZoom()
+{
+    // Wheel zooming repaints everything on each tick, so draw those quickly
+    static_cast<EditorGraphicsView*>(ui->graphicsView)->BeginDraftRendering();
+
+    // Replaces the old transform rather than combining with it
+    ui->graphicsView->setTransform(QTransform::fromScale(iZoomLevel, iZoomLevel));
 }
 
 EditorTab::~EditorTab()
@@ -574,18 +529,24 @@ EditorTab::~EditorTab()
     delete ui;
 }
 
+void EditorTab::RefreshPropertyEditorValues()
+{
+    auto pTree = static_cast<PropertyTreeWidget*>(ui->treeWidget);
+    pTree->GetPropertyModel().AllPropertiesChanged();
+}
+
 void EditorTab::ClearPropertyEditor()
 {
     auto pTree = static_cast<PropertyTreeWidget*>(ui->treeWidget);
     pTree->DePopulate();
 }
 
-void EditorTab::PopulatePropertyEditor(QGraphicsItem* pItem)
+void EditorTab::PopulatePropertyEditor(const QList<QGraphicsItem*>& items)
 {
     ClearPropertyEditor();
 
     auto pTree = static_cast<PropertyTreeWidget*>(ui->treeWidget);
-    pTree->Populate(*mModel, mUndoStack, pItem);
+    pTree->Populate(*mModel, mUndoStack, items);
 }
 
 void EditorTab::Undo()
@@ -778,6 +739,9 @@ void EditorTab::EditPathData()
 
 void EditorTab::EditMapSize()
 {
+    // Removing cameras needs their items and the items of their map objects
+    PopulateAllItems();
+
     auto pDlg = new ChangeMapSizeDialog(this, this);
     pDlg->exec();
     delete pDlg;
@@ -817,7 +781,7 @@ public:
 
     void undo() override
     {
-        mTab->GetScene().removeItem(mArrowItem);
+        mTab->GetScene().RemoveItem(mArrowItem);
 
         mNewObject = mTab->GetModel().RemoveCollisionItem(mArrowItem->GetCollisionItem());
 
@@ -828,7 +792,7 @@ public:
 
     void redo() override
     {
-        mTab->GetScene().addItem(mArrowItem);
+        mTab->GetScene().AddItem(mArrowItem);
         mTab->GetModel().CollisionItems().push_back(std::move(mNewObject));
 
         // Set the new item as the only thing selected
@@ -902,7 +866,7 @@ void EditorTab::ConnectCollisions()
             }
         }
 
-        std::vector<CollisionConnectData> collisionConnectData = CollisionConnectCommand::getConnectCollisionsChanges(collisions);
+        std::vector<CollisionConnectData> collisionConnectData = CollisionConnectCommand::getConnectCollisionsChanges(*mScene, collisions);
 
         if (!collisionConnectData.empty())
         {
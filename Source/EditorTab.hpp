@@ -8,6 +8,8 @@
 #include <QPainter>
 #include <QTreeWidget>
 #include <QApplication>
+#include <QTimer>
+#include <vector>
 #include <memory>
 #include "Model.hpp"
 #include "SnapSettings.hpp"
@@ -42,7 +44,7 @@ public:
     QString GetJsonFileName() const { return mJsonFileName; }
     Model& GetModel() const { return *mModel; }
     void ClearPropertyEditor();
-    void PopulatePropertyEditor(QGraphicsItem* pItem);
+    void PopulatePropertyEditor(const QList<QGraphicsItem*>& items);
     void Undo();
     void Redo();
     void wheelEvent(QWheelEvent* pEvent) override;
@@ -74,6 +76,10 @@ public:
 
     void ConnectCollisions();
 
+    // Creates the graphics items for the cameras that are still only in the model, call before
+    // anything that needs every camera, map object and collision to have an item
+    void PopulateAllItems();
+
     ResizeableRectItem* MakeResizeableRectItem(MapObject* pMapObject);
     ResizeableArrowItem* MakeResizeableArrowItem(CollisionObject* pCollisionObject);
     CameraGraphicsItem* MakeCameraGraphicsItem(Camera* pCamera, int x, int y, int w, int h);
@@ -90,6 +96,9 @@ public:
 
     void SyncPropertyEditor();
 
+    // The shown items might have new values, the rows stay the same
+    void RefreshPropertyEditorValues();
+
     void EditTransparency();
 
     void Cut(ClipBoard& clipBoard);
@@ -105,6 +114,23 @@ private slots:
 
 private:
     bool DoSave(QString fileName);
+    void ApplyZoom();
+
+    // A camera along with its map objects and the collisions whose middle is inside it that don't
+    // have graphics items yet. Taken from the model when the tab opens so anything added since
+    // already has its own item.
+    struct UnpopulatedCell final
+    {
+        int mX = 0;
+        int mY = 0;
+        Camera* mCamera = nullptr;
+        std::vector<MapObject*> mMapObjects;
+        std::vector<CollisionObject*> mCollisions;
+    };
+
+    QRectF CellRect(const UnpopulatedCell& cell) const;
+    void PopulateItemsBatch();
+    void PopulateCell(const UnpopulatedCell& cell);
 
     int SnapX(bool enabled, int x) override;
     int SnapY(bool enabled, int y) override;
@@ -127,4 +153,7 @@ private:
     QStatusBar* mStatusBar = nullptr;
 
     SnapSettings& mSnapSettings;
+
+    std::vector<UnpopulatedCell> mUnpopulatedCells;
+    QTimer mPopulateTimer;
 };
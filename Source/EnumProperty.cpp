@@ -1,92 +1,39 @@
 #include "EnumProperty.hpp"
 #include "Model.hpp"
 #include "IGraphicsItem.hpp"
-#include <QComboBox>
 
-ChangeEnumPropertyCommand::ChangeEnumPropertyCommand(LinkedProperty linkedProperty, EnumPropertyChangeData propertyData)
-    : mLinkedProperty(linkedProperty), mPropertyData(propertyData)
+ChangeEnumPropertyCommand::ChangeEnumPropertyCommand(std::vector<LinkedProperty> linkedProperties, EnumPropertyChangeData propertyData)
+    : mLinkedProperties(std::move(linkedProperties)), mPropertyData(std::move(propertyData))
 {
-    setText(QString("Change property %1 from %2 to %3").arg(mLinkedProperty.mProperty->mName.c_str(), mPropertyData.mEnum->mValues[mPropertyData.mOldIdx].c_str(), mPropertyData.mEnum->mValues[mPropertyData.mNewIdx].c_str()));
-}
-
-void ChangeEnumPropertyCommand::undo()
-{
-    mLinkedProperty.mProperty->mEnumValue = mPropertyData.mEnum->mValues[mPropertyData.mOldIdx];
-    mLinkedProperty.mTreeWidget->FindObjectPropertyByKey(mLinkedProperty.mProperty)->Refresh();
-    mLinkedProperty.mGraphicsItem->SyncInternalObject();
-}
-
-void ChangeEnumPropertyCommand::redo()
-{
-    mLinkedProperty.mProperty->mEnumValue = mPropertyData.mEnum->mValues[mPropertyData.mNewIdx];
-    mLinkedProperty.mTreeWidget->FindObjectPropertyByKey(mLinkedProperty.mProperty)->Refresh();
-    mLinkedProperty.mGraphicsItem->SyncInternalObject();
-}
-
-EnumProperty::EnumProperty(QUndoStack& undoStack, QTreeWidgetItem* pParent, ObjectProperty* pProperty, IGraphicsItem* pGraphicsItem, Enum* pEnum) : PropertyTreeItemBase(pParent, QStringList{ kIndent + pProperty->mName.c_str(), pProperty->mEnumValue.c_str() }), mUndoStack(undoStack), mProperty(pProperty), mGraphicsItem(pGraphicsItem), mEnum(pEnum)
-{
-
-}
-
-QWidget* EnumProperty::CreateEditorWidget(PropertyTreeWidget* pParent)
-{
-    mCombo = new QComboBox(pParent);
-    for (auto& item : mEnum->mValues)
+    const LinkedProperty& first = mLinkedProperties[0];
+    const std::vector<std::string>& values = mPropertyData.mEnum->mValues;
+    if (mLinkedProperties.size() == 1)
     {
-        mCombo->addItem(item.c_str());
+        setText(QString("Change property %1 from %2 to %3").arg(first.mProperty->mName.c_str(), values[mPropertyData.mOldIdxs[0]].c_str(), values[mPropertyData.mNewIdx].c_str()));
     }
-    SetPropertyIndexFromEnumValue();
-    Refresh();
-
-    if (mOldIdx != -1)
+    else
     {
-        mCombo->setCurrentIndex(mOldIdx);
+        setText(QString("Change property %1 of %2 objects to %3").arg(first.mProperty->mName.c_str(), QString::number(mLinkedProperties.size()), values[mPropertyData.mNewIdx].c_str()));
     }
-
-    connect(mCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [pParent, this](int index)
-        {
-            if (index != -1 && mOldIdx != index)
-            {
-                mUndoStack.push(new ChangeEnumPropertyCommand(
-                    LinkedProperty(pParent, this->mProperty, this->mGraphicsItem),
-                    EnumPropertyChangeData(this->mEnum, this->mOldIdx, index)));
-            }
-            mOldIdx = index;
-        });
-
-    connect(mCombo, &QComboBox::destroyed, this, [this](QObject*)
-        {
-            this->mCombo = nullptr;
-        });
-    return mCombo;
 }
 
-void EnumProperty::Refresh()
+void ChangeEnumPropertyCommand::undo()
 {
-    // Update the idx based on the enum value
-    SetPropertyIndexFromEnumValue();
-
-    // Update the text to match the enum value via its index
-    setText(1, mEnum->mValues[mOldIdx].c_str());
-
-    if (mCombo)
+    for (size_t i = 0; i < mLinkedProperties.size(); i++)
     {
-        // If the combo is open then set the correct item in the drop down
-        mCombo->setCurrentIndex(mOldIdx);
+        LinkedProperty& linkedProperty = mLinkedProperties[i];
+        linkedProperty.mProperty->mEnumValue = mPropertyData.mEnum->mValues[mPropertyData.mOldIdxs[i]];
+        linkedProperty.mTreeWidget->RefreshProperty(linkedProperty.mProperty);
+        linkedProperty.mGraphicsItem->SyncInternalObject();
     }
 }
 
-void EnumProperty::SetPropertyIndexFromEnumValue()
+void ChangeEnumPropertyCommand::redo()
 {
-    mOldIdx = -1;
-    int i = 0;
-    for (auto& item : mEnum->mValues)
+    for (LinkedProperty& linkedProperty : mLinkedProperties)
     {
-        if (mProperty->mEnumValue == item.c_str())
-        {
-            mOldIdx = i;
-            break;
-        }
-        i++;
+        linkedProperty.mProperty->mEnumValue = mPropertyData.mEnum->mValues[mPropertyData.mNewIdx];
+        linkedProperty.mTreeWidget->RefreshProperty(linkedProperty.mProperty);
+        linkedProperty.mGraphicsItem->SyncInternalObject();
     }
 }
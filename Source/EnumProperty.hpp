@@ -1,62 +1,37 @@
 #pragma once
 
-#include "PropertyTreeItemBase.hpp"
+#include "PropertyTreeWidget.hpp"
 #include <QUndoCommand>
-#include <QComboBox>
+#include <vector>
 
 struct Enum;
 class QUndoStack;
 
 struct EnumPropertyChangeData
 {
-    EnumPropertyChangeData(Enum* pEnum, int oldIdx, int newIdx)
-        : mEnum(pEnum), mOldIdx(oldIdx), mNewIdx(newIdx)
+    EnumPropertyChangeData(Enum* pEnum, std::vector<int> oldIdxs, int newIdx)
+        : mEnum(pEnum), mOldIdxs(std::move(oldIdxs)), mNewIdx(newIdx)
     {
 
     }
     Enum* mEnum = nullptr;
-    int mOldIdx = 0;
+
+    // One per linked property
+    std::vector<int> mOldIdxs;
     int mNewIdx = 0;
 };
 
+// Sets the property of every selected object at once, each item is synced once per undo or redo
 class ChangeEnumPropertyCommand : public QUndoCommand
 {
 public:
-    ChangeEnumPropertyCommand(LinkedProperty linkedProperty, EnumPropertyChangeData propertyData);
+    ChangeEnumPropertyCommand(std::vector<LinkedProperty> linkedProperties, EnumPropertyChangeData propertyData);
 
     void undo() override;
 
     void redo() override;
 
 private:
-    LinkedProperty mLinkedProperty;
+    std::vector<LinkedProperty> mLinkedProperties;
     EnumPropertyChangeData mPropertyData;
 };
-
-class EnumProperty final : public QObject, public PropertyTreeItemBase
-{
-    Q_OBJECT
-public:
-    EnumProperty(QUndoStack& undoStack, QTreeWidgetItem* pParent, ObjectProperty* pProperty, IGraphicsItem* pGraphicsItem, Enum* pEnum);
-
-    QWidget* CreateEditorWidget(PropertyTreeWidget* pParent) override;
-
-    void Refresh() override;
-
-    const void* GetPropertyLookUpKey() const override
-    {
-        return mProperty;
-    }
-
-
-private:
-    void SetPropertyIndexFromEnumValue();
-
-    QUndoStack& mUndoStack;
-    ObjectProperty* mProperty = nullptr;
-    IGraphicsItem* mGraphicsItem = nullptr;
-    Enum* mEnum = nullptr;
-    int mOldIdx = -1;
-
-    QComboBox* mCombo = nullptr;
-};
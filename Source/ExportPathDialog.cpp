@@ -110,7 +110,7 @@ bool ExportPathDialog::ExportToLvl(ReliveAPI::Context& context)
     return exportJsonToLvl(jsonPath, lvlPath, partialTemporaryFilePath, [&](const QString text)
         {
             QMessageBox::critical(this, "Error", text);
-        }, stdLvls, context);
+        }, stdLvls, context, ui->chkPatchInPlace->isChecked() ? LvlExportMode::PatchInPlace : LvlExportMode::Replace);
 }
 
 void ExportPathDialog::on_buttonBox_accepted()
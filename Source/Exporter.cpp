@@ -3,9 +3,19 @@
 #include <QUuid>
 #include "ReliveApiWrapper.hpp"
 #include "file_api.hpp"
+#include "LvlPatcher.hpp"
 
-bool exportJsonToLvl(QString jsonPath, QString lvlPath, QString partialTemporaryFilePath, std::function<void(const QString)> onFailure, std::set<std::string>& resourceSources, ReliveAPI::Context& context)
+bool exportJsonToLvl(QString jsonPath, QString lvlPath, QString partialTemporaryFilePath, std::function<void(const QString)> onFailure, std::set<std::string>& resourceSources, ReliveAPI::Context& context, LvlExportMode mode)
 {
+    // A previous patch of this lvl might have been interrupted, put it back the way it was
+    // before we read it again
+    QString recoveryError;
+    if (!RecoverInterruptedLvlPatch(lvlPath, recoveryError))
+    {
+        onFailure(recoveryError);
+        return false;
+    }
+
     EditorFileIO fileIo;
     auto fnExport = [&]()
     {
@@ -32,6 +42,26 @@ bool exportJsonToLvl(QString jsonPath, QString lvlPath, QString partialTemporary
             resourceSourcesVec,
             context);
 
+        if (mode == LvlExportMode::PatchInPlace)
+        {
+            QString patchError;
+            const LvlPatchResult result = PatchLvlInPlace(lvlPath, tempFileFullPath, patchError);
+            if (result == LvlPatchResult::Patched)
+            {
+                QFile::remove(tempFileFullPath);
+                return true;
+            }
+
+            if (result == LvlPatchResult::Failed)
+            {
+                onFailure(patchError);
+                QFile::remove(tempFileFullPath);
+                return false;
+            }
+
+            // NeedsCompaction, fall back to replacing the whole lvl
+        }
+
         // Then overwrite the original lvl with the temp one
         if (!QFile::remove(lvlPath))
         {
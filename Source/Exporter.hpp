@@ -9,4 +9,13 @@ namespace ReliveAPI
     class Context;
 }
 
-bool exportJsonToLvl(QString jsonPath, QString lvlPath, QString partialTemporaryFilePath, std::function<void(const QString)> onFailure, std::set<std::string>& resourceSources, ReliveAPI::Context& context);
+enum class LvlExportMode
+{
+    // Write a whole new lvl and swap it in place of the original
+    Replace,
+
+    // Only write the lvl entries that changed into the original lvl
+    PatchInPlace,
+};
+
+bool exportJsonToLvl(QString jsonPath, QString lvlPath, QString partialTemporaryFilePath, std::function<void(const QString)> onFailure, std::set<std::string>& resourceSources, ReliveAPI::Context& context, LvlExportMode mode = LvlExportMode::Replace);
@@ -0,0 +1,589 @@
+#include "LvlPatcher.hpp"
+#include <QFile>
+#include <QtEndian>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <vector>
+#include <map>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// LVL layout: a sector aligned header holding the file index followed by the file data,
+// every file starts on a sector boundary.
+const qint64 kSectorSize = 2048;
+const qint64 kHeaderFieldsSize = 32;
+const qint64 kFileRecordSize = 24;
+const qint64 kFileNameLength = 12;
+const quint32 kIndxMagic = 0x78646E49; // "Indx"
+
+// Replace the whole LVL if more than this much of it would be unreferenced sectors
+const double kMaxDeadSpaceRatio = 0.25;
+
+const QByteArray kJournalMagic("LVLJRNL1");
+const QByteArray kJournalCommitMarker("LVLJDONE");
+const QByteArray kJournalAppliedMarker("LVLAPPLY");
+const QByteArray kHashIndexMagic("LVLHASH1");
+
+struct LvlFileRecord final
+{
+    QByteArray mName;
+    qint64 mStartSector = 0;
+    qint64 mNumSectors = 0;
+    qint64 mFileSize = 0;
+};
+
+struct LvlIndex final
+{
+    QByteArray mHeader;
+    qint64 mFirstFileOffset = 0;
+    std::vector<LvlFileRecord> mRecords;
+
+    qint64 Capacity() const
+    {
+        return (mFirstFileOffset - kHeaderFieldsSize) / kFileRecordSize;
+    }
+};
+
+static qint64 SectorsFor(qint64 bytes)
+{
+    return (bytes + kSectorSize - 1) / kSectorSize;
+}
+
+static qint32 ReadS32(const QByteArray& data, qint64 offset)
+{
+    return qFromLittleEndian<qint32>(reinterpret_cast<const uchar*>(data.constData() + offset));
+}
+
+static void WriteS32(QByteArray& data, qint64 offset, qint32 value)
+{
+    qToLittleEndian<qint32>(value, reinterpret_cast<uchar*>(data.data() + offset));
+}
+
+static bool SyncToDisk(QFile& file)
+{
+    if (!file.flush())
+    {
+        return false;
+    }
+#ifdef _WIN32
+    return ::_commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+static bool ReadIndex(QFile& file, LvlIndex& index, QString& error)
+{
+    if (!file.seek(0))
+    {
+        error = "Failed to seek to the start of " + file.fileName();
+        return false;
+    }
+
+    QByteArray fields = file.read(kHeaderFieldsSize);
+    if (fields.size() != kHeaderFieldsSize || static_cast<quint32>(ReadS32(fields, 8)) != kIndxMagic)
+    {
+        error = file.fileName() + " is not a valid LVL file";
+        return false;
+    }
+
+    index.mFirstFileOffset = ReadS32(fields, 0);
+    const qint64 numFiles = ReadS32(fields, 16);
+    if (index.mFirstFileOffset < kHeaderFieldsSize || numFiles < 0 || numFiles > index.Capacity())
+    {
+        error = file.fileName() + " has a corrupted LVL index";
+        return false;
+    }
+
+    if (!file.seek(0))
+    {
+        error = "Failed to seek to the start of " + file.fileName();
+        return false;
+    }
+
+    index.mHeader = file.read(index.mFirstFileOffset);
+    if (index.mHeader.size() != index.mFirstFileOffset)
+    {
+        error = "Failed to read the LVL index of " + file.fileName();
+        return false;
+    }
+
+    index.mRecords.clear();
+    for (qint64 i = 0; i < numFiles; i++)
+    {
+        const qint64 recOffset = kHeaderFieldsSize + (i * kFileRecordSize);
+        LvlFileRecord rec;
+        rec.mName = index.mHeader.mid(static_cast<int>(recOffset), kFileNameLength);
+        rec.mStartSector = ReadS32(index.mHeader, recOffset + 12);
+        rec.mNumSectors = ReadS32(index.mHeader, recOffset + 16);
+        rec.mFileSize = ReadS32(index.mHeader, recOffset + 20);
+
+        if (rec.mStartSector * kSectorSize < index.mFirstFileOffset || rec.mFileSize < 0)
+        {
+            error = file.fileName() + " has a corrupted LVL index";
+            return false;
+        }
+        index.mRecords.push_back(rec);
+    }
+    return true;
+}
+
+static QByteArray ReadRecordData(QFile& file, const LvlFileRecord& rec)
+{
+    if (!file.seek(rec.mStartSector * kSectorSize))
+    {
+        return QByteArray();
+    }
+    return file.read(rec.mFileSize);
+}
+
+static QByteArray PadToSectors(QByteArray data)
+{
+    data.append(QByteArray(static_cast<int>((SectorsFor(data.size()) * kSectorSize) - data.size()), '\0'));
+    return data;
+}
+
+static QByteArray BuildHeader(const LvlIndex& oldIndex, const std::vector<LvlFileRecord>& records)
+{
+    // Keep the unknown header fields as they were and only rewrite the file count and records
+    QByteArray header = oldIndex.mHeader;
+    header.fill('\0', -1);
+    header.replace(0, kHeaderFieldsSize, oldIndex.mHeader.left(kHeaderFieldsSize));
+    WriteS32(header, 16, static_cast<qint32>(records.size()));
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const qint64 recOffset = kHeaderFieldsSize + (static_cast<qint64>(i) * kFileRecordSize);
+        header.replace(static_cast<int>(recOffset), kFileNameLength, records[i].mName);
+        WriteS32(header, recOffset + 12, static_cast<qint32>(records[i].mStartSector));
+        WriteS32(header, recOffset + 16, static_cast<qint32>(records[i].mNumSectors));
+        WriteS32(header, recOffset + 20, static_cast<qint32>(records[i].mFileSize));
+    }
+    return header;
+}
+
+static QString JournalPath(const QString& lvlPath)
+{
+    return lvlPath + ".patch-journal";
+}
+
+static QString HashIndexPath(const QString& lvlPath)
+{
+    return lvlPath + ".patch-hashes";
+}
+
+static QByteArray HashOf(const QByteArray& data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+// The hash of every file in the LVL as of the last patch, so the next patch can tell what changed
+// without reading the old data back. Only trusted while the LVL is the same size, has the same
+// modification time and index as when it was written, anything else writing the LVL makes it stale.
+using LvlHashIndex = std::map<QByteArray, QByteArray>;
+
+static LvlHashIndex ReadHashIndex(const QString& lvlPath, const LvlIndex& index)
+{
+    QFile file(HashIndexPath(lvlPath));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return LvlHashIndex();
+    }
+
+    QDataStream stream(&file);
+    QByteArray magic(kHashIndexMagic.size(), '\0');
+    stream.readRawData(magic.data(), magic.size());
+
+    qint64 lvlSize = 0;
+    qint64 lvlModified = 0;
+    QByteArray headerHash;
+    quint32 count = 0;
+    stream >> lvlSize >> lvlModified >> headerHash >> count;
+
+    const QFileInfo lvlInfo(lvlPath);
+    if (magic != kHashIndexMagic || stream.status() != QDataStream::Ok || lvlSize != lvlInfo.size() ||
+        lvlModified != lvlInfo.lastModified().toMSecsSinceEpoch() || headerHash != HashOf(index.mHeader))
+    {
+        return LvlHashIndex();
+    }
+
+    LvlHashIndex hashes;
+    for (quint32 i = 0; i < count; i++)
+    {
+        QByteArray name;
+        QByteArray hash;
+        stream >> name >> hash;
+        hashes[name] = hash;
+    }
+    return stream.status() == QDataStream::Ok ? hashes : LvlHashIndex();
+}
+
+static void WriteHashIndex(const QString& lvlPath, const LvlHashIndex& hashes)
+{
+    QFile lvl(lvlPath);
+    LvlIndex index;
+    QString error;
+    if (!lvl.open(QIODevice::ReadOnly) || !ReadIndex(lvl, index, error))
+    {
+        QFile::remove(HashIndexPath(lvlPath));
+        return;
+    }
+    lvl.close();
+
+    QFile file(HashIndexPath(lvlPath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return;
+    }
+
+    const QFileInfo lvlInfo(lvlPath);
+    QDataStream stream(&file);
+    stream.writeRawData(kHashIndexMagic.constData(), kHashIndexMagic.size());
+    stream << lvlInfo.size() << lvlInfo.lastModified().toMSecsSinceEpoch() << HashOf(index.mHeader) << static_cast<quint32>(hashes.size());
+    for (const auto& [name, hash] : hashes)
+    {
+        stream << name << hash;
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        file.close();
+        QFile::remove(file.fileName());
+    }
+}
+
+// The records hold the name padded with nulls to kFileNameLength
+static QString RecordName(const LvlFileRecord& rec)
+{
+    const int end = rec.mName.indexOf('\0');
+    return QString::fromLatin1(end >= 0 ? rec.mName.left(end) : rec.mName);
+}
+
+QByteArray LvlFileHash(const QString& lvlPath, const QString& fileName)
+{
+    QFile lvl(lvlPath);
+    LvlIndex index;
+    QString error;
+    if (!lvl.open(QIODevice::ReadOnly) || !ReadIndex(lvl, index, error))
+    {
+        return QByteArray();
+    }
+
+    for (const auto& rec : index.mRecords)
+    {
+        if (RecordName(rec).compare(fileName, Qt::CaseInsensitive) != 0)
+        {
+            continue;
+        }
+
+        const LvlHashIndex hashes = ReadHashIndex(lvlPath, index);
+        auto it = hashes.find(rec.mName);
+        if (it != hashes.end())
+        {
+            return it->second;
+        }
+
+        const QByteArray data = ReadRecordData(lvl, rec);
+        return data.size() == rec.mFileSize ? HashOf(data) : QByteArray();
+    }
+    return QByteArray();
+}
+
+struct PendingWrite final
+{
+    qint64 mOffset = 0;
+    QByteArray mData;
+};
+
+static bool WriteJournal(const QString& lvlPath, qint64 originalSize, const QByteArray& originalHeader, const std::vector<PendingWrite>& overwrites, QFile& lvl, QString& error)
+{
+    QFile journal(JournalPath(lvlPath));
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        error = "Failed to create the patch journal " + journal.fileName();
+        return false;
+    }
+
+    QDataStream stream(&journal);
+    stream.writeRawData(kJournalMagic.constData(), kJournalMagic.size());
+    stream << originalSize << originalHeader << static_cast<quint32>(overwrites.size());
+
+    // Save what is about to be overwritten so it can be put back
+    for (const auto& write : overwrites)
+    {
+        if (!lvl.seek(write.mOffset))
+        {
+            error = "Failed to read the data to be overwritten in " + lvlPath;
+            return false;
+        }
+        stream << write.mOffset << lvl.read(write.mData.size());
+    }
+
+    stream.writeRawData(kJournalCommitMarker.constData(), kJournalCommitMarker.size());
+
+    if (stream.status() != QDataStream::Ok || !SyncToDisk(journal))
+    {
+        error = "Failed to write the patch journal " + journal.fileName();
+        return false;
+    }
+    return true;
+}
+
+// Appended once the new index is on the disk, from then on the patch is complete and must not be rolled back
+static bool MarkJournalApplied(const QString& lvlPath)
+{
+    QFile journal(JournalPath(lvlPath));
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        return false;
+    }
+    return journal.write(kJournalAppliedMarker) == kJournalAppliedMarker.size() && SyncToDisk(journal);
+}
+
+bool RecoverInterruptedLvlPatch(const QString& lvlPath, QString& error)
+{
+    QFile journal(JournalPath(lvlPath));
+    if (!journal.exists())
+    {
+        return true;
+    }
+
+    if (!journal.open(QIODevice::ReadOnly))
+    {
+        error = "Failed to open the patch journal " + journal.fileName();
+        return false;
+    }
+
+    const QByteArray journalData = journal.readAll();
+    journal.close();
+
+    // Died after the patch was committed but before the journal was removed, the LVL is fine as it is.
+    // The hashes next to it may still be from before the patch.
+    if (journalData.startsWith(kJournalMagic) && journalData.endsWith(kJournalAppliedMarker))
+    {
+        QFile::remove(HashIndexPath(lvlPath));
+        QFile::remove(journal.fileName());
+        return true;
+    }
+
+    // The LVL is only touched after the journal is fully written, if the commit marker is missing
+    // then the LVL is still in its original state.
+    if (!journalData.startsWith(kJournalMagic) || !journalData.endsWith(kJournalCommitMarker))
+    {
+        QFile::remove(journal.fileName());
+        return true;
+    }
+
+    QDataStream stream(journalData.mid(kJournalMagic.size()));
+    qint64 originalSize = 0;
+    QByteArray originalHeader;
+    quint32 overwriteCount = 0;
+    stream >> originalSize >> originalHeader >> overwriteCount;
+
+    std::vector<PendingWrite> undo(overwriteCount);
+    for (auto& write : undo)
+    {
+        stream >> write.mOffset >> write.mData;
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        error = "The patch journal " + journal.fileName() + " is corrupted, " + lvlPath + " may need to be re-exported";
+        return false;
+    }
+
+    QFile lvl(lvlPath);
+    if (!lvl.open(QIODevice::ReadWrite))
+    {
+        error = "Failed to open " + lvlPath + " to roll back an interrupted patch";
+        return false;
+    }
+
+    for (auto it = undo.rbegin(); it != undo.rend(); it++)
+    {
+        if (!lvl.seek(it->mOffset) || lvl.write(it->mData) != it->mData.size())
+        {
+            error = "Failed to roll back an interrupted patch of " + lvlPath;
+            return false;
+        }
+    }
+
+    if (!lvl.seek(0) || lvl.write(originalHeader) != originalHeader.size() || !lvl.resize(originalSize) || !SyncToDisk(lvl))
+    {
+        error = "Failed to roll back an interrupted patch of " + lvlPath;
+        return false;
+    }
+    lvl.close();
+
+    QFile::remove(journal.fileName());
+    return true;
+}
+
+LvlPatchResult PatchLvlInPlace(const QString& lvlPath, const QString& updatedLvlPath, QString& error)
+{
+    QFile lvl(lvlPath);
+    if (!lvl.open(QIODevice::ReadWrite))
+    {
+        error = "Failed to open " + lvlPath + " for patching";
+        return LvlPatchResult::Failed;
+    }
+
+    QFile updatedLvl(updatedLvlPath);
+    if (!updatedLvl.open(QIODevice::ReadOnly))
+    {
+        error = "Failed to open " + updatedLvlPath;
+        return LvlPatchResult::Failed;
+    }
+
+    LvlIndex oldIndex;
+    LvlIndex newIndex;
+    if (!ReadIndex(lvl, oldIndex, error) || !ReadIndex(updatedLvl, newIndex, error))
+    {
+        return LvlPatchResult::Failed;
+    }
+
+    if (static_cast<qint64>(newIndex.mRecords.size()) > oldIndex.Capacity())
+    {
+        // No room for more records without moving all of the file data
+        return LvlPatchResult::NeedsCompaction;
+    }
+
+    // Falls back to reading the old data when there are no hashes from a previous patch
+    const LvlHashIndex oldHashes = ReadHashIndex(lvlPath, oldIndex);
+    LvlHashIndex newHashes;
+
+    std::map<QByteArray, const LvlFileRecord*> oldRecordsByName;
+    for (const auto& rec : oldIndex.mRecords)
+    {
+        oldRecordsByName[rec.mName] = &rec;
+    }
+
+    const qint64 originalSize = lvl.size();
+    qint64 tailSector = SectorsFor(originalSize);
+
+    std::vector<LvlFileRecord> patchedRecords;
+    std::vector<PendingWrite> overwrites;
+    std::vector<PendingWrite> appends;
+    qint64 liveSectors = 0;
+
+    for (const auto& newRec : newIndex.mRecords)
+    {
+        const QByteArray newData = ReadRecordData(updatedLvl, newRec);
+        if (newData.size() != newRec.mFileSize)
+        {
+            error = "Failed to read " + QString(newRec.mName) + " from " + updatedLvlPath;
+            return LvlPatchResult::Failed;
+        }
+
+        const QByteArray newHash = HashOf(newData);
+        newHashes[newRec.mName] = newHash;
+
+        LvlFileRecord patchedRec = newRec;
+        patchedRec.mNumSectors = SectorsFor(newRec.mFileSize);
+
+        auto oldIt = oldRecordsByName.find(newRec.mName);
+        if (oldIt != oldRecordsByName.end())
+        {
+            const LvlFileRecord& oldRec = *oldIt->second;
+            auto oldHashIt = oldHashes.find(oldRec.mName);
+            const bool unchanged = oldRec.mFileSize == newRec.mFileSize &&
+                (oldHashIt != oldHashes.end() ? oldHashIt->second == newHash : HashOf(ReadRecordData(lvl, oldRec)) == newHash);
+            if (unchanged)
+            {
+                // Unchanged, keep it where it is
+                patchedRecords.push_back(oldRec);
+                liveSectors += oldRec.mNumSectors;
+                continue;
+            }
+
+            if (oldRec.mNumSectors >= patchedRec.mNumSectors)
+            {
+                // Still fits in the sectors it had
+                patchedRec.mStartSector = oldRec.mStartSector;
+                overwrites.push_back({ oldRec.mStartSector * kSectorSize, PadToSectors(newData) });
+                patchedRecords.push_back(patchedRec);
+                liveSectors += patchedRec.mNumSectors;
+                continue;
+            }
+        }
+
+        // New or grown, relocate it to the end of the file
+        patchedRec.mStartSector = tailSector;
+        tailSector += patchedRec.mNumSectors;
+        appends.push_back({ patchedRec.mStartSector * kSectorSize, PadToSectors(newData) });
+        patchedRecords.push_back(patchedRec);
+        liveSectors += patchedRec.mNumSectors;
+    }
+
+    if (overwrites.empty() && appends.empty() && patchedRecords.size() == oldIndex.mRecords.size())
+    {
+        // Nothing changed
+        lvl.close();
+        if (oldHashes.empty())
+        {
+            WriteHashIndex(lvlPath, newHashes);
+        }
+        return LvlPatchResult::Patched;
+    }
+
+    const qint64 headerSectors = SectorsFor(oldIndex.mFirstFileOffset);
+    const qint64 deadSectors = tailSector - headerSectors - liveSectors;
+    if (static_cast<double>(deadSectors) / static_cast<double>(tailSector) > kMaxDeadSpaceRatio)
+    {
+        return LvlPatchResult::NeedsCompaction;
+    }
+
+    if (!WriteJournal(lvlPath, originalSize, oldIndex.mHeader, overwrites, lvl, error))
+    {
+        QFile::remove(JournalPath(lvlPath));
+        return LvlPatchResult::Failed;
+    }
+
+    // Write all of the data first, the old index still points at the old data until the new one is written
+    if (!lvl.resize(tailSector * kSectorSize))
+    {
+        error = "Failed to grow " + lvlPath;
+        lvl.close();
+        QString recoveryError;
+        RecoverInterruptedLvlPatch(lvlPath, recoveryError);
+        return LvlPatchResult::Failed;
+    }
+
+    for (const auto* writes : { &appends, &overwrites })
+    {
+        for (const auto& write : *writes)
+        {
+            if (!lvl.seek(write.mOffset) || lvl.write(write.mData) != write.mData.size())
+            {
+                error = "Failed to write patched data to " + lvlPath;
+                lvl.close();
+                QString recoveryError;
+                RecoverInterruptedLvlPatch(lvlPath, recoveryError);
+                return LvlPatchResult::Failed;
+            }
+        }
+    }
+
+    const QByteArray newHeader = BuildHeader(oldIndex, patchedRecords);
+    if (!SyncToDisk(lvl) || !lvl.seek(0) || lvl.write(newHeader) != newHeader.size() || !SyncToDisk(lvl))
+    {
+        error = "Failed to write the patched index of " + lvlPath;
+        lvl.close();
+        QString recoveryError;
+        RecoverInterruptedLvlPatch(lvlPath, recoveryError);
+        return LvlPatchResult::Failed;
+    }
+    lvl.close();
+
+    // If this fails the journal is removed straight after anyway, a partly written marker leaves the
+    // journal without its commit marker which recovery also treats as nothing to roll back
+    MarkJournalApplied(lvlPath);
+    QFile::remove(JournalPath(lvlPath));
+    WriteHashIndex(lvlPath, newHashes);
+    return LvlPatchResult::Patched;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+enum class LvlPatchResult
+{
+    // Only the changed entries were written into the existing LVL
+    Patched,
+
+    // Patching would leave too much dead space or there is no room left in the
+    // LVL index, the caller should replace the whole LVL instead
+    NeedsCompaction,
+
+    // Something went wrong, the error string says what
+    Failed,
+};
+
+// Compares the index of lvlPath with the freshly exported updatedLvlPath and writes only
+// the entries that differ into lvlPath. Entries that still fit in their old sectors are
+// overwritten in place, entries that grew are appended to the end of the file. An undo
+// journal is written next to the LVL before it is touched so an interrupted patch can be
+// rolled back with RecoverInterruptedLvlPatch(). The hashes of the patched files are kept
+// next to the LVL so the next patch doesn't need to read the old data to find what changed.
+LvlPatchResult PatchLvlInPlace(const QString& lvlPath, const QString& updatedLvlPath, QString& error);
+
+// SHA-1 of one file inside the LVL, e.g. its path BND, so things made from that file can be kept
+// for as long as its contents stay the same. Uses the hashes the last patch kept when they are
+// still valid and reads the file otherwise. Empty if the LVL can't be read or doesn't have it.
+QByteArray LvlFileHash(const QString& lvlPath, const QString& fileName);
+
+// Rolls back a patch that didn't complete, does nothing if there is no journal for lvlPath.
+// A patch that got as far as writing its new index is kept and only the journal is removed.
+// Call before reading the LVL, it's corrupt until this has been done.
+bool RecoverInterruptedLvlPatch(const QString& lvlPath, QString& error);
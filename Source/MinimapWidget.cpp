@@ -0,0 +1,187 @@
+#include "MinimapWidget.hpp"
+#include <QGraphicsView>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <cmath>
+#include "EditorGraphicsScene.hpp"
+
+// Longest side of the cached render, the widget scales it to fit
+static const int kMinimapImageSize = 1024;
+
+// Changes are collected for this long before the dirty parts are rendered again, so dragging
+// an item around doesn't render the minimap on every mouse move
+static const int kMinimapRenderDelayMs = 100;
+
+MinimapWidget::MinimapWidget(EditorGraphicsScene* pScene, QGraphicsView* pView, QWidget* pParent)
+    : QWidget(pParent), mScene(pScene), mView(pView)
+{
+    setCursor(Qt::PointingHandCursor);
+
+    mRenderTimer.setSingleShot(true);
+    mRenderTimer.setInterval(kMinimapRenderDelayMs);
+    connect(&mRenderTimer, &QTimer::timeout, this, &MinimapWidget::RenderDirtyRegion);
+
+    // Not QGraphicsScene::changed, connecting to that makes every view repaint through updateScene
+    connect(mScene, &EditorGraphicsScene::ContentChanged, this, &MinimapWidget::OnSceneChanged);
+    connect(mScene, &QGraphicsScene::sceneRectChanged, this, &MinimapWidget::RebuildCache);
+
+    // Scrolling and zooming both end up moving or resizing the scroll bars, only the outline
+    // of the view has to be redrawn for those
+    auto repaintOutline = [this]() { update(); };
+    connect(mView->horizontalScrollBar(), &QScrollBar::valueChanged, this, repaintOutline);
+    connect(mView->verticalScrollBar(), &QScrollBar::valueChanged, this, repaintOutline);
+    connect(mView->horizontalScrollBar(), &QScrollBar::rangeChanged, this, repaintOutline);
+    connect(mView->verticalScrollBar(), &QScrollBar::rangeChanged, this, repaintOutline);
+
+    RebuildCache();
+}
+
+QSize MinimapWidget::sizeHint() const
+{
+    return QSize(300, 150);
+}
+
+void MinimapWidget::OnSceneChanged(const QRectF& dirtyRect)
+{
+    if (mCache.isNull())
+    {
+        return;
+    }
+
+    // Grown by a pixel so anti aliased edges that land between image pixels are redone too
+    mDirtyRegion += SceneToImage(dirtyRect).toAlignedRect().adjusted(-1, -1, 1, 1);
+
+    if (!mDirtyRegion.isEmpty() && !mRenderTimer.isActive())
+    {
+        mRenderTimer.start();
+    }
+}
+
+void MinimapWidget::RebuildCache()
+{
+    const QRectF sceneRect = mScene->sceneRect();
+    if (sceneRect.isEmpty())
+    {
+        mCache = QImage();
+        return;
+    }
+
+    mScale = kMinimapImageSize / std::max(sceneRect.width(), sceneRect.height());
+    const QSize imageSize(std::max(1, static_cast<int>(std::ceil(sceneRect.width() * mScale))), std::max(1, static_cast<int>(std::ceil(sceneRect.height() * mScale))));
+    mCache = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+
+    mDirtyRegion = QRegion(mCache.rect());
+    mRenderTimer.stop();
+    RenderDirtyRegion();
+}
+
+void MinimapWidget::RenderDirtyRegion()
+{
+    if (mCache.isNull())
+    {
+        mDirtyRegion = QRegion();
+        return;
+    }
+
+    const QRegion dirty = mDirtyRegion.intersected(mCache.rect());
+    mDirtyRegion = QRegion();
+    if (dirty.isEmpty())
+    {
+        return;
+    }
+
+    // Text is unreadable at this size anyway and cameras only draw what is already decoded
+    mScene->SetMinimapRendering(true);
+
+    const QRectF sceneRect = mScene->sceneRect();
+    QPainter painter(&mCache);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (const QRect& imageRect : dirty)
+    {
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(imageRect, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+        const QRectF source(sceneRect.left() + (imageRect.x() / mScale), sceneRect.top() + (imageRect.y() / mScale), imageRect.width() / mScale, imageRect.height() / mScale);
+        mScene->render(&painter, imageRect, source, Qt::IgnoreAspectRatio);
+    }
+    painter.end();
+
+    mScene->SetMinimapRendering(false);
+
+    update();
+}
+
+QRectF MinimapWidget::ImageRect() const
+{
+    if (mCache.isNull())
+    {
+        return QRectF();
+    }
+
+    QSizeF fitted = QSizeF(mCache.size());
+    fitted.scale(QSizeF(size()), Qt::KeepAspectRatio);
+    return QRectF(QPointF((width() - fitted.width()) / 2.0, (height() - fitted.height()) / 2.0), fitted);
+}
+
+QRectF MinimapWidget::SceneToImage(const QRectF& sceneRect) const
+{
+    const QPointF origin = mScene->sceneRect().topLeft();
+    return QRectF((sceneRect.topLeft() - origin) * mScale, sceneRect.size() * mScale);
+}
+
+void MinimapWidget::paintEvent(QPaintEvent*)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+
+    const QRectF imageRect = ImageRect();
+    if (imageRect.isEmpty())
+    {
+        return;
+    }
+
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(imageRect, mCache);
+
+    // Outline the part of the scene the view is showing
+    const QRectF visibleScene = mView->mapToScene(mView->viewport()->rect()).boundingRect();
+    const QRectF visibleImage = SceneToImage(visibleScene);
+    const qreal widgetScale = imageRect.width() / mCache.width();
+    const QRectF outline(imageRect.topLeft() + (visibleImage.topLeft() * widgetScale), visibleImage.size() * widgetScale);
+
+    painter.setPen(QPen(Qt::red, 2));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(outline.intersected(imageRect));
+}
+
+void MinimapWidget::CentreViewOn(const QPoint& widgetPos)
+{
+    const QRectF imageRect = ImageRect();
+    if (imageRect.isEmpty())
+    {
+        return;
+    }
+
+    const QRectF sceneRect = mScene->sceneRect();
+    const QPointF relative = (QPointF(widgetPos) - imageRect.topLeft());
+    const QPointF scenePos(sceneRect.left() + (relative.x() / imageRect.width()) * sceneRect.width(), sceneRect.top() + (relative.y() / imageRect.height()) * sceneRect.height());
+    mView->centerOn(scenePos);
+}
+
+void MinimapWidget::mousePressEvent(QMouseEvent* pEvent)
+{
+    if (pEvent->button() == Qt::LeftButton)
+    {
+        CentreViewOn(pEvent->pos());
+    }
+}
+
+void MinimapWidget::mouseMoveEvent(QMouseEvent* pEvent)
+{
+    if (pEvent->buttons() & Qt::LeftButton)
+    {
+        CentreViewOn(pEvent->pos());
+    }
+}
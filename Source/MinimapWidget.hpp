@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QImage>
+#include <QRegion>
+#include <QTimer>
+#include <QWidget>
+
+class EditorGraphicsScene;
+class QGraphicsView;
+
+// Shows the whole path at a small scale with the area the view is looking at outlined, clicking
+// or dragging centres the view there. The scene is rendered once into a cached image and after
+// that only the parts the scene reports as changed are rendered again.
+class MinimapWidget final : public QWidget
+{
+public:
+    MinimapWidget(EditorGraphicsScene* pScene, QGraphicsView* pView, QWidget* pParent = nullptr);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* pEvent) override;
+    void mousePressEvent(QMouseEvent* pEvent) override;
+    void mouseMoveEvent(QMouseEvent* pEvent) override;
+
+private:
+    void OnSceneChanged(const QRectF& dirtyRect);
+    void RebuildCache();
+    void RenderDirtyRegion();
+    void CentreViewOn(const QPoint& widgetPos);
+
+    // Where the cached image is drawn inside the widget, kept to the aspect ratio of the scene
+    QRectF ImageRect() const;
+    QRectF SceneToImage(const QRectF& sceneRect) const;
+
+    EditorGraphicsScene* mScene = nullptr;
+    QGraphicsView* mView = nullptr;
+
+    QImage mCache;
+    qreal mScale = 1.0;
+    QRegion mDirtyRegion;
+    QTimer mRenderTimer;
+};
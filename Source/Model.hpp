@@ -347,6 +347,11 @@ public:
         return mCollisions;
     }
 
+    const std::vector<UP_CollisionObject>& CollisionItems() const
+    {
+        return mCollisions;
+    }
+
     struct FoundType final
     {
         Enum* mEnum = nullptr;
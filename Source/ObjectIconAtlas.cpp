@@ -0,0 +1,98 @@
+#include "ObjectIconAtlas.hpp"
+#include <QDirIterator>
+#include <QImage>
+#include <QPainter>
+#include <algorithm>
+#include <vector>
+
+static const char* kObjectImagesPath = ":/object_images/rsc/object_images/";
+static const int kAtlasWidth = 2048;
+
+// Space between icons so smooth scaling doesn't pull in the edges of the neighbouring ones
+static const int kIconPadding = 2;
+
+static const ObjectIconAtlas* gAtlas = nullptr;
+
+const ObjectIconAtlas& ObjectIconAtlas::Instance()
+{
+    Q_ASSERT(gAtlas);
+    return *gAtlas;
+}
+
+ObjectIconAtlas::~ObjectIconAtlas()
+{
+    if (gAtlas == this)
+    {
+        gAtlas = nullptr;
+    }
+}
+
+ObjectIconAtlas::ObjectIconAtlas()
+{
+    Q_ASSERT(!gAtlas);
+    gAtlas = this;
+
+    struct Icon final
+    {
+        QString mKey;
+        QImage mImage;
+    };
+
+    const QString rootPath = kObjectImagesPath;
+    std::vector<Icon> icons;
+    QDirIterator it(rootPath, QStringList() << "*.png", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        const QString path = it.next();
+        QImage image(path);
+        if (image.isNull())
+        {
+            continue;
+        }
+
+        QString key = path.mid(rootPath.length());
+        key.chop(4); // .png
+        icons.push_back({ key, image });
+    }
+
+    if (icons.empty())
+    {
+        return;
+    }
+
+    // Rows of icons, tallest first so each row wastes as little height as possible
+    std::sort(icons.begin(), icons.end(), [](const Icon& a, const Icon& b)
+    {
+        return a.mImage.height() > b.mImage.height();
+    });
+
+    std::vector<QPoint> positions;
+    positions.reserve(icons.size());
+    int x = 0;
+    int y = 0;
+    int rowHeight = 0;
+    for (const Icon& icon : icons)
+    {
+        if (x > 0 && x + icon.mImage.width() > kAtlasWidth)
+        {
+            x = 0;
+            y += rowHeight;
+            rowHeight = 0;
+        }
+        positions.push_back(QPoint(x, y));
+        x += icon.mImage.width() + kIconPadding;
+        rowHeight = std::max(rowHeight, icon.mImage.height() + kIconPadding);
+    }
+
+    QImage atlas(kAtlasWidth, y + rowHeight, QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+    QPainter painter(&atlas);
+    for (size_t i = 0; i < icons.size(); i++)
+    {
+        painter.drawImage(positions[i], icons[i].mImage);
+        mIconRects.insert(icons[i].mKey, QRect(positions[i], icons[i].mImage.size()));
+    }
+    painter.end();
+
+    mPixmap = QPixmap::fromImage(atlas);
+}
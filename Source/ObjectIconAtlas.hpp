@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QHash>
+#include <QPixmap>
+#include <QRect>
+#include <QString>
+
+// Every object icon in the resources packed into one pixmap, so finding an icon is a hash
+// lookup and nothing can be evicted and loaded again. The main window owns the atlas so the
+// pixmap is freed while the QApplication still exists.
+class ObjectIconAtlas final
+{
+public:
+    ObjectIconAtlas();
+    ~ObjectIconAtlas();
+    ObjectIconAtlas(const ObjectIconAtlas&) = delete;
+    ObjectIconAtlas& operator=(const ObjectIconAtlas&) = delete;
+
+    // The atlas that is alive right now, only valid while the main window exists
+    static const ObjectIconAtlas& Instance();
+
+    const QPixmap& Pixmap() const
+    {
+        return mPixmap;
+    }
+
+    // Where the icon is in Pixmap(), a null rect if there isn't one. The key is the icons path
+    // under rsc/object_images without the extension, e.g. "Alarm" or "Edge/Left".
+    QRect IconRect(const QString& key) const
+    {
+        return mIconRects.value(key);
+    }
+
+private:
+    QPixmap mPixmap;
+    QHash<QString, QRect> mIconRects;
+};
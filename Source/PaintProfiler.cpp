@@ -0,0 +1,51 @@
+#include "PaintProfiler.hpp"
+
+#ifdef EDITOR_PAINT_PROFILER
+
+namespace PaintProfiler
+{
+    // Items are only ever painted on the GUI thread
+    static Stats* gFrameStats = nullptr;
+
+    const char* ItemClassName(ItemClass itemClass)
+    {
+        switch (itemClass)
+        {
+        case ItemClass::Camera:
+            return "CameraGraphicsItem";
+        case ItemClass::MapObject:
+            return "ResizeableRectItem";
+        case ItemClass::Collision:
+            return "ResizeableArrowItem";
+        case ItemClass::BatchedLayer:
+            return "BatchedLayerItem";
+        default:
+            return "";
+        }
+    }
+
+    void AddPaint(ItemClass itemClass, qint64 ns)
+    {
+        if (!gFrameStats)
+        {
+            return;
+        }
+
+        ItemClassStats& stats = (*gFrameStats)[static_cast<size_t>(itemClass)];
+        stats.mPaintCount++;
+        stats.mPaintNs += ns;
+    }
+
+    ScopedFrame::ScopedFrame(Stats& stats)
+        : mPreviousFrame(gFrameStats)
+    {
+        gFrameStats = &stats;
+    }
+
+    ScopedFrame::~ScopedFrame()
+    {
+        gFrameStats = mPreviousFrame;
+    }
+}
+
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+// Paint timings for the overlay the view draws when built with QT_EDITOR_PAINT_PROFILER. Without
+// it PAINT_PROFILE_SCOPE expands to nothing and none of this is compiled.
+#ifdef EDITOR_PAINT_PROFILER
+
+#include <QElapsedTimer>
+#include <array>
+
+namespace PaintProfiler
+{
+    enum class ItemClass
+    {
+        Camera,
+        MapObject,
+        Collision,
+        BatchedLayer,
+        Count
+    };
+
+    struct ItemClassStats final
+    {
+        int mPaintCount = 0;
+        qint64 mPaintNs = 0;
+    };
+
+    using Stats = std::array<ItemClassStats, static_cast<size_t>(ItemClass::Count)>;
+
+    const char* ItemClassName(ItemClass itemClass);
+
+    // Counted into the frame that is being profiled, dropped when there isn't one
+    void AddPaint(ItemClass itemClass, qint64 ns);
+
+    // Paints made while it's alive are counted into stats. A view wraps only its own paintEvent
+    // in one, so the minimap and other views rendering the same scene don't count towards it.
+    class ScopedFrame final
+    {
+    public:
+        explicit ScopedFrame(Stats& stats);
+        ~ScopedFrame();
+
+    private:
+        Stats* mPreviousFrame = nullptr;
+    };
+
+    class ScopedPaintTimer final
+    {
+    public:
+        explicit ScopedPaintTimer(ItemClass itemClass)
+            : mItemClass(itemClass)
+        {
+            mTimer.start();
+        }
+
+        ~ScopedPaintTimer()
+        {
+            AddPaint(mItemClass, mTimer.nsecsElapsed());
+        }
+
+    private:
+        ItemClass mItemClass;
+        QElapsedTimer mTimer;
+    };
+}
+
+#define PAINT_PROFILE_SCOPE(itemClass) PaintProfiler::ScopedPaintTimer paintProfileScope(PaintProfiler::ItemClass::itemClass)
+
+#else
+
+#define PAINT_PROFILE_SCOPE(itemClass)
+
+#endif
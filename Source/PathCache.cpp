@@ -0,0 +1,246 @@
+#include "PathCache.hpp"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QMap>
+#include <QSet>
+#include <QUuid>
+#include <algorithm>
+#include "Model.hpp"
+#include "LvlPatcher.hpp"
+#include "ReliveApiWrapper.hpp"
+
+// Size in pixels of one camera in the thumbnail before it gets scaled to fit
+const int kThumbnailCameraWidth = 24;
+const int kThumbnailCameraHeight = 16;
+
+// A camera with this many objects or more gets the strongest shade
+const int kMaxObjectDensity = 8;
+
+// Every edit of an LVL gives it a new fingerprint and every edit of a path BND a new thumbnail
+// key, only the most recently used ones are kept
+const int kMaxCachedLvls = 64;
+
+static QString CacheDir()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/paths";
+    QDir().mkpath(dir);
+    return dir;
+}
+
+static QString ThumbnailFileName(const QString& thumbnailKey, int pathId)
+{
+    return CacheDir() + "/" + thumbnailKey + "_" + QString::number(pathId) + ".png";
+}
+
+// Deletes everything cached for all but the most recently written fingerprints and thumbnail
+// keys, a fingerprint has one enumeration .json and a thumbnail key a .png per path
+static void TrimCache()
+{
+    const QFileInfoList files = QDir(CacheDir()).entryInfoList(QStringList() << "*.json" << "*.png", QDir::Files);
+
+    QMap<QString, qint64> lastWrittenByFingerprint;
+    for (const QFileInfo& file : files)
+    {
+        const QString fingerprint = file.completeBaseName().section('_', 0, 0);
+        qint64& lastWritten = lastWrittenByFingerprint[fingerprint];
+        lastWritten = std::max(lastWritten, file.lastModified().toMSecsSinceEpoch());
+    }
+
+    if (lastWrittenByFingerprint.size() <= kMaxCachedLvls)
+    {
+        return;
+    }
+
+    std::vector<std::pair<qint64, QString>> byAge;
+    for (auto it = lastWrittenByFingerprint.constBegin(); it != lastWrittenByFingerprint.constEnd(); it++)
+    {
+        byAge.emplace_back(it.value(), it.key());
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    QSet<QString> stale;
+    for (size_t i = 0; i < byAge.size() - kMaxCachedLvls; i++)
+    {
+        stale.insert(byAge[i].second);
+    }
+
+    for (const QFileInfo& file : files)
+    {
+        if (stale.contains(file.completeBaseName().section('_', 0, 0)))
+        {
+            QFile::remove(file.absoluteFilePath());
+        }
+    }
+}
+
+QString LvlFingerprint(const QString& lvlFile)
+{
+    const QFileInfo info(lvlFile);
+    const QString key = info.absoluteFilePath() + "|" +
+        QString::number(info.size()) + "|" +
+        QString::number(info.lastModified().toMSecsSinceEpoch()) + "|" +
+        QString::number(ReliveAPI::GetApiVersion());
+    return QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+}
+
+ReliveAPI::EnumeratePathsResult EnumeratePathsCached(ReliveAPI::IFileIO& fileIo, const QString& lvlFile)
+{
+    const QString cacheFileName = CacheDir() + "/" + LvlFingerprint(lvlFile) + ".json";
+
+    QFile cacheFile(cacheFileName);
+    if (cacheFile.open(QIODevice::ReadOnly))
+    {
+        const QJsonObject cached = QJsonDocument::fromJson(cacheFile.readAll()).object();
+        if (cached.contains("path_bnd") && cached.contains("paths"))
+        {
+            ReliveAPI::EnumeratePathsResult ret;
+            ret.pathBndName = cached["path_bnd"].toString().toStdString();
+            for (const auto& path : cached["paths"].toArray())
+            {
+                ret.paths.push_back(path.toInt());
+            }
+            return ret;
+        }
+        cacheFile.close();
+    }
+
+    ReliveAPI::EnumeratePathsResult ret = ReliveAPI::EnumeratePaths(fileIo, lvlFile.toStdString());
+
+    QJsonArray paths;
+    for (int path : ret.paths)
+    {
+        paths.append(path);
+    }
+
+    QJsonObject cached;
+    cached["path_bnd"] = QString::fromStdString(ret.pathBndName);
+    cached["paths"] = paths;
+
+    // Not being able to write the cache just means we enumerate again next time
+    if (cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        cacheFile.write(QJsonDocument(cached).toJson());
+        cacheFile.close();
+    }
+
+    // Only a new fingerprint can take the cache over the limit
+    TrimCache();
+
+    return ret;
+}
+
+QString PathThumbnailKey(const QString& lvlFile, const std::string& pathBndName)
+{
+    const QByteArray bndHash = LvlFileHash(lvlFile, QString::fromStdString(pathBndName));
+    if (bndHash.isEmpty())
+    {
+        return QString();
+    }
+
+    // A new API version might convert the same BND differently
+    const QByteArray key = bndHash + "|" + QByteArray::number(ReliveAPI::GetApiVersion());
+    return QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+}
+
+QImage LoadCachedPathThumbnail(const QString& thumbnailKey, int pathId)
+{
+    if (thumbnailKey.isEmpty())
+    {
+        return QImage();
+    }
+    return QImage(ThumbnailFileName(thumbnailKey, pathId));
+}
+
+static QImage RenderThumbnail(const Model& model)
+{
+    const MapInfo& mapInfo = model.GetMapInfo();
+    const int xSize = std::max(mapInfo.mXSize, 1);
+    const int ySize = std::max(mapInfo.mYSize, 1);
+
+    QImage image(xSize * kThumbnailCameraWidth, ySize * kThumbnailCameraHeight, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor(32, 32, 32));
+
+    QPainter painter(&image);
+    for (const auto& camera : model.GetCameras())
+    {
+        const QRect cameraRect(camera->mX * kThumbnailCameraWidth, camera->mY * kThumbnailCameraHeight, kThumbnailCameraWidth, kThumbnailCameraHeight);
+        if (!camera->mName.empty())
+        {
+            painter.fillRect(cameraRect.adjusted(1, 1, -1, -1), QColor(80, 80, 80));
+        }
+
+        const int density = std::min(static_cast<int>(camera->mMapObjects.size()), kMaxObjectDensity);
+        if (density > 0)
+        {
+            painter.fillRect(cameraRect.adjusted(1, 1, -1, -1), QColor(220, 60, 40, 40 + (density * 200 / kMaxObjectDensity)));
+        }
+    }
+
+    if (mapInfo.mXGridSize > 0 && mapInfo.mYGridSize > 0)
+    {
+        const qreal xScale = static_cast<qreal>(kThumbnailCameraWidth) / mapInfo.mXGridSize;
+        const qreal yScale = static_cast<qreal>(kThumbnailCameraHeight) / mapInfo.mYGridSize;
+
+        painter.setPen(QColor(120, 220, 120));
+        for (const auto& collision : model.CollisionItems())
+        {
+            painter.drawLine(QPointF(collision->X1() * xScale, collision->Y1() * yScale), QPointF(collision->X2() * xScale, collision->Y2() * yScale));
+        }
+    }
+    painter.end();
+
+    return image.scaled(kPathThumbnailWidth, kPathThumbnailHeight, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
+
+static QImage RenderAndCacheThumbnail(const Model& model, const QString& thumbnailKey, int pathId)
+{
+    const QImage thumbnail = RenderThumbnail(model);
+    if (!thumbnail.isNull() && !thumbnailKey.isEmpty())
+    {
+        thumbnail.save(ThumbnailFileName(thumbnailKey, pathId), "PNG");
+    }
+    return thumbnail;
+}
+
+void CachePathThumbnail(const Model& model, const QString& thumbnailKey, int pathId)
+{
+    RenderAndCacheThumbnail(model, thumbnailKey, pathId);
+}
+
+QImage CreatePathThumbnail(ReliveAPI::IFileIO& fileIo, const QString& lvlFile, const QString& thumbnailKey, int pathId)
+{
+    const QString jsonFile = QDir::tempPath() + "/thumbnail_" + QUuid::createUuid().toString(QUuid::WithoutBraces) + ".json";
+
+    const bool converted = ExecApiCall([&]()
+        {
+            ReliveAPI::Context context;
+            ReliveAPI::ExportPathBinaryToJson(fileIo, jsonFile.toStdString(), lvlFile.toStdString(), pathId, context);
+            return true;
+        }, [](const QString&) {});
+
+    QImage thumbnail;
+    if (converted)
+    {
+        try
+        {
+            Model model;
+            model.LoadJsonFromFile(jsonFile.toStdString());
+            thumbnail = RenderAndCacheThumbnail(model, thumbnailKey, pathId);
+        }
+        catch (const ModelException&)
+        {
+            // No thumbnail, opening the path reports what is wrong with it
+        }
+    }
+
+    QFile::remove(jsonFile);
+    return thumbnail;
+}
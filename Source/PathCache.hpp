@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+#include <QImage>
+#include "relive_api.hpp"
+
+class Model;
+
+const int kPathThumbnailWidth = 160;
+const int kPathThumbnailHeight = 100;
+
+// Identifies an LVL by where it is, its size and when it was last written so anything
+// cached for it is ignored once it changes
+QString LvlFingerprint(const QString& lvlFile);
+
+// EnumeratePaths but the result is kept on disk per LVL fingerprint, throws the same as EnumeratePaths
+ReliveAPI::EnumeratePathsResult EnumeratePathsCached(ReliveAPI::IFileIO& fileIo, const QString& lvlFile);
+
+// Thumbnails are kept per contents of the path BND that holds the paths rather than per LVL
+// fingerprint, so exporting other paths or cameras leaves them alone. Empty if the BND can't
+// be found, nothing is cached then. Reads the BND unless the last patch kept its hash.
+QString PathThumbnailKey(const QString& lvlFile, const std::string& pathBndName);
+
+// Null image if there is no thumbnail for the path yet
+QImage LoadCachedPathThumbnail(const QString& thumbnailKey, int pathId);
+
+// Draws the camera grid of a path that was just loaded, shaded by how many objects each camera
+// has, along with the collision lines and caches it for the path selection dialog. Can be
+// called from any thread.
+void CachePathThumbnail(const Model& model, const QString& thumbnailKey, int pathId);
+
+// Converts the path just to make its thumbnail and caches it, as slow as opening the path so
+// only call it from a worker. Null image if the path couldn't be converted.
+QImage CreatePathThumbnail(ReliveAPI::IFileIO& fileIo, const QString& lvlFile, const QString& thumbnailKey, int pathId);
@@ -0,0 +1,135 @@
+#include "PathExtractor.hpp"
+#include <QDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrent>
+#include <iostream>
+#include <vector>
+#include "ReliveApiWrapper.hpp"
+#include "ShowContext.hpp"
+#include "LvlPatcher.hpp"
+
+struct PathExtractionJob final
+{
+    QString mLvlFile;
+    int mPathId = 0;
+    QString mJsonFile;
+
+    bool mOk = false;
+    QString mError;
+    QString mContextWarnings;
+};
+
+static void ExtractPath(PathExtractionJob& job)
+{
+    // Each job has its own file IO and context so nothing is shared between threads
+    EditorFileIO fileIo;
+    ReliveAPI::Context context;
+
+    job.mOk = ExecApiCall([&]()
+        {
+            ReliveAPI::ExportPathBinaryToJson(fileIo, job.mJsonFile.toStdString(), job.mLvlFile.toStdString(), job.mPathId, context);
+            return true;
+        },
+        [&](const QString err)
+        {
+            job.mError = err;
+        });
+
+    if (!context.Ok())
+    {
+        job.mContextWarnings = ContextToString(context);
+    }
+}
+
+int ExtractPathsCommandLine(const QStringList& args)
+{
+    if (args.size() < 2)
+    {
+        std::cerr << "Incorrect usage of the --extract option, should be --extract lvl1 [lvl2 ...] outputDir" << std::endl;
+        return 1;
+    }
+
+    const QString outputDir = args.last();
+    if (!QDir().mkpath(outputDir))
+    {
+        std::cerr << "Failed to create output directory " << outputDir.toStdString() << std::endl;
+        return 1;
+    }
+
+    int runResult = 0;
+    std::vector<PathExtractionJob> jobs;
+
+    EditorFileIO fileIo;
+    for (int i = 0; i < args.size() - 1; i++)
+    {
+        const QString lvlFile = args.at(i);
+
+        QString recoveryError;
+        if (!RecoverInterruptedLvlPatch(lvlFile, recoveryError))
+        {
+            std::cerr << recoveryError.toStdString() << std::endl;
+            runResult = 1;
+            continue;
+        }
+
+        ReliveAPI::EnumeratePathsResult ret;
+        const bool enumerated = ExecApiCall([&]()
+            {
+                ret = ReliveAPI::EnumeratePaths(fileIo, lvlFile.toStdString());
+                return true;
+            },
+            [&](const QString err)
+            {
+                std::cerr << "Failed to enumerate the paths in " << lvlFile.toStdString() << ". " << err.toStdString() << std::endl;
+            });
+
+        if (!enumerated)
+        {
+            runResult = 1;
+            continue;
+        }
+
+        const QString lvlName = QFileInfo(lvlFile).completeBaseName();
+        for (const int pathId : ret.paths)
+        {
+            PathExtractionJob job;
+            job.mLvlFile = lvlFile;
+            job.mPathId = pathId;
+            job.mJsonFile = QDir(outputDir).filePath(lvlName + "_" + QString::number(pathId) + ".json");
+            jobs.push_back(job);
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QtConcurrent::blockingMap(jobs, ExtractPath);
+
+    int failedCount = 0;
+    for (const auto& job : jobs)
+    {
+        if (job.mOk)
+        {
+            std::cout << "Extracted " << job.mLvlFile.toStdString() << " path " << job.mPathId << " to " << job.mJsonFile.toStdString() << std::endl;
+        }
+        else
+        {
+            std::cerr << "Extracting " << job.mLvlFile.toStdString() << " path " << job.mPathId << " failed. " << job.mError.toStdString() << std::endl;
+            failedCount++;
+        }
+
+        if (!job.mContextWarnings.isEmpty())
+        {
+            std::cout << job.mContextWarnings.toStdString();
+        }
+    }
+
+    std::cout << "Extracted " << (jobs.size() - failedCount) << " of " << jobs.size() << " paths in " << timer.elapsed() << "ms" << std::endl;
+
+    if (failedCount > 0)
+    {
+        runResult = 1;
+    }
+    return runResult;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <QStringList>
+
+// Handles --extract lvl1 [lvl2 ...] outputDir, every path in every LVL is converted to
+// outputDir/<lvl name>_<path id>.json. Paths are converted in parallel and each gets its
+// own context report. Returns the process exit code.
+int ExtractPathsCommandLine(const QStringList& args);
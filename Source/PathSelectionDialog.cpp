@@ -1,40 +1,119 @@
 #include "PathSelectionDialog.hpp"
 #include "ui_PathSelectionDialog.h"
 #include "relive_api.hpp"
+#include "ReliveApiWrapper.hpp"
+#include "PathCache.hpp"
+#include <QCoreApplication>
+#include <QPointer>
+#include <QThread>
+#include <QThreadPool>
 
-PathSelectionDialog::PathSelectionDialog(QWidget *parent, ReliveAPI::EnumeratePathsResult& paths) :
+PathSelectionDialog::PathSelectionDialog(QWidget *parent, ReliveAPI::EnumeratePathsResult& paths, const QString& lvlFileName) :
     QDialog(parent, Qt::WindowMaximizeButtonHint | Qt::WindowCloseButtonHint),
     ui(new Ui::PathSelectionDialog),
-    mPaths(paths)
+    mPaths(paths),
+    mStopThumbnails(std::make_shared<std::atomic<bool>>(false))
 {
     ui->setupUi(this);
+    ui->listWidget->setIconSize(QSize(kPathThumbnailWidth, kPathThumbnailHeight));
 
-    for (int path : mPaths.paths)
+    const QString thumbnailKey = PathThumbnailKey(lvlFileName, mPaths.pathBndName);
+    std::vector<int> missingThumbnails;
+    for (int i = 0; i < static_cast<int>(mPaths.paths.size()); i++)
     {
+        const int path = mPaths.paths[i];
         auto item = new QListWidgetItem(QString::fromStdString(mPaths.pathBndName + "!" + std::to_string(path)));
         ui->listWidget->addItem(item);
+
+        const QImage thumbnail = LoadCachedPathThumbnail(thumbnailKey, path);
+        if (!thumbnail.isNull())
+        {
+            item->setIcon(QPixmap::fromImage(thumbnail));
+        }
+        else
+        {
+            missingThumbnails.push_back(path);
+        }
+    }
+
+    if (!thumbnailKey.isEmpty() && !missingThumbnails.empty())
+    {
+        CreateMissingThumbnails(lvlFileName, thumbnailKey, std::move(missingThumbnails));
     }
 }
 
 PathSelectionDialog::~PathSelectionDialog()
 {
+    *mStopThumbnails = true;
     delete ui;
 }
 
+void PathSelectionDialog::CreateMissingThumbnails(const QString& lvlFileName, const QString& thumbnailKey, std::vector<int> pathIds)
+{
+    // One path at a time on a single low priority worker, behind anything else the pool has queued,
+    // so picking paths and opening them isn't held up by previews nobody waited for
+    const std::shared_ptr<std::atomic<bool>> stop = mStopThumbnails;
+    const QPointer<PathSelectionDialog> pDialog(this);
+    QThreadPool::globalInstance()->start([stop, pDialog, lvlFileName, thumbnailKey, pathIds]()
+        {
+            QThread::currentThread()->setPriority(QThread::LowestPriority);
+
+            // Not a CachedLvlFileIO, that would keep the whole LVL in memory
+            EditorFileIO fileIo;
+            for (int pathId : pathIds)
+            {
+                if (*stop)
+                {
+                    break;
+                }
+
+                const QImage thumbnail = CreatePathThumbnail(fileIo, lvlFileName, thumbnailKey, pathId);
+                QMetaObject::invokeMethod(QCoreApplication::instance(), [pDialog, pathId, thumbnail]()
+                    {
+                        if (pDialog)
+                        {
+                            pDialog->SetThumbnail(pathId, thumbnail);
+                        }
+                    }, Qt::QueuedConnection);
+            }
+
+            QThread::currentThread()->setPriority(QThread::NormalPriority);
+        }, -1);
+}
+
+void PathSelectionDialog::SetThumbnail(int pathId, const QImage& thumbnail)
+{
+    if (thumbnail.isNull())
+    {
+        return;
+    }
+
+    for (int i = 0; i < static_cast<int>(mPaths.paths.size()); i++)
+    {
+        if (mPaths.paths[i] == pathId)
+        {
+            ui->listWidget->item(i)->setIcon(QPixmap::fromImage(thumbnail));
+            return;
+        }
+    }
+}
+
 void PathSelectionDialog::on_buttonBox_accepted()
 {
-    mSelectedPath = std::nullopt;
+    mSelectedPaths.clear();
 
-    QList<QListWidgetItem*> selection = ui->listWidget->selectedItems();
-    if (!selection.empty())
+    // Keep them in the same order as the list rather than the order they were clicked in
+    for (int i = 0; i < ui->listWidget->count(); i++)
     {
-        const int idx = ui->listWidget->currentIndex().row();
-        mSelectedPath = std::make_optional(mPaths.paths[idx]);
+        if (ui->listWidget->item(i)->isSelected())
+        {
+            mSelectedPaths.push_back(mPaths.paths[i]);
+        }
     }
 }
 
 void PathSelectionDialog::on_buttonBox_rejected()
 {
-    mSelectedPath = std::nullopt;
+    mSelectedPaths.clear();
 }
 
@@ -2,7 +2,10 @@
 #define PATHSELECTIONDIALOG_HPP
 
 #include <QDialog>
-#include <optional>
+#include <QImage>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace ReliveAPI {
     struct EnumeratePathsResult;
@@ -17,12 +20,12 @@ class PathSelectionDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit PathSelectionDialog(QWidget *parent, ReliveAPI::EnumeratePathsResult& paths);
+    explicit PathSelectionDialog(QWidget *parent, ReliveAPI::EnumeratePathsResult& paths, const QString& lvlFileName);
     ~PathSelectionDialog();
 
-    std::optional<int> SelectedPath() const
+    const std::vector<int>& SelectedPaths() const
     {
-        return mSelectedPath;
+        return mSelectedPaths;
     }
 
 private slots:
@@ -31,9 +34,15 @@ private slots:
     void on_buttonBox_rejected();
 
 private:
+    void CreateMissingThumbnails(const QString& lvlFileName, const QString& thumbnailKey, std::vector<int> pathIds);
+    void SetThumbnail(int pathId, const QImage& thumbnail);
+
     Ui::PathSelectionDialog *ui;
-    std::optional<int> mSelectedPath;
+    std::vector<int> mSelectedPaths;
     ReliveAPI::EnumeratePathsResult& mPaths;
+
+    // Set when the dialog closes so the worker making the missing thumbnails stops after the current one
+    std::shared_ptr<std::atomic<bool>> mStopThumbnails;
 };
 
 #endif // PATHSELECTIONDIALOG_HPP
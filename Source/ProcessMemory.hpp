@@ -0,0 +1,7 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Peak resident memory of the whole process so far in KB. It's a high-water mark, so it only
+// ever grows. Kept out of the callers so they don't have to see windows.h.
+qint64 PeakProcessMemoryKb();
@@ -0,0 +1,310 @@
+#include "PropertyDelegate.hpp"
+#include <QComboBox>
+#include <QLineEdit>
+#include <QSignalBlocker>
+#include <QStringListModel>
+#include <QUndoStack>
+#include "PropertyTreeWidget.hpp"
+#include "PropertyModel.hpp"
+#include "BigSpinBox.hpp"
+#include "BasicTypeProperty.hpp"
+#include "EnumProperty.hpp"
+#include "StringProperty.hpp"
+
+static int EnumIndexOf(const Enum& enumType, const std::string& value)
+{
+    for (int i = 0; i < static_cast<int>(enumType.mValues.size()); i++)
+    {
+        if (enumType.mValues[i] == value)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+PropertyDelegate::PropertyDelegate(PropertyTreeWidget* pTreeWidget)
+    : QStyledItemDelegate(pTreeWidget), mTreeWidget(pTreeWidget)
+{
+
+}
+
+QWidget* PropertyDelegate::createEditor(QWidget* pParent, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const PropertyModel::Row& row = mTreeWidget->GetPropertyModel().RowAt(index.row());
+    switch (row.mKind)
+    {
+    case PropertyModel::RowKind::String:
+        return TakeLineEdit(pParent);
+
+    case PropertyModel::RowKind::BasicType:
+    {
+        BigSpinBox* pSpinBox = TakeSpinBox(pParent);
+        pSpinBox->setMax(row.mBasicType->mMaxValue);
+        pSpinBox->setMin(row.mBasicType->mMinValue);
+        return pSpinBox;
+    }
+
+    case PropertyModel::RowKind::Enumeration:
+    {
+        // Swapping the model isn't an edit
+        QComboBox* pCombo = TakeComboBox(pParent);
+        const QSignalBlocker blocker(pCombo);
+        pCombo->setModel(EnumValuesModel(*row.mEnum));
+        return pCombo;
+    }
+
+    default:
+        return QStyledItemDelegate::createEditor(pParent, option, index);
+    }
+}
+
+void PropertyDelegate::destroyEditor(QWidget* pEditor, const QModelIndex& index) const
+{
+    // The view is done with it, keep it around for the next property of the same kind
+    if (auto pCombo = qobject_cast<QComboBox*>(pEditor))
+    {
+        mFreeComboBoxes.push_back(pCombo);
+    }
+    else if (auto pSpinBox = qobject_cast<BigSpinBox*>(pEditor))
+    {
+        mFreeSpinBoxes.push_back(pSpinBox);
+    }
+    else if (auto pEdit = qobject_cast<QLineEdit*>(pEditor))
+    {
+        mFreeLineEdits.push_back(pEdit);
+    }
+    else
+    {
+        QStyledItemDelegate::destroyEditor(pEditor, index);
+        return;
+    }
+
+    pEditor->hide();
+    pEditor->clearFocus();
+    pEditor->setParent(mTreeWidget);
+}
+
+QLineEdit* PropertyDelegate::TakeLineEdit(QWidget* pParent) const
+{
+    if (!mFreeLineEdits.empty())
+    {
+        QLineEdit* pEdit = mFreeLineEdits.back();
+        mFreeLineEdits.pop_back();
+        pEdit->setParent(pParent);
+        return pEdit;
+    }
+
+    // Signals can't be emitted from a const function, the editors commit as they change
+    auto pThis = const_cast<PropertyDelegate*>(this);
+    auto pEdit = new QLineEdit(pParent);
+    pEdit->setMaxLength(20);
+    connect(pEdit, &QLineEdit::editingFinished, pThis, [pThis, pEdit]()
+        {
+            emit pThis->commitData(pEdit);
+        });
+    return pEdit;
+}
+
+BigSpinBox* PropertyDelegate::TakeSpinBox(QWidget* pParent) const
+{
+    if (!mFreeSpinBoxes.empty())
+    {
+        BigSpinBox* pSpinBox = mFreeSpinBoxes.back();
+        mFreeSpinBoxes.pop_back();
+        pSpinBox->setParent(pParent);
+        return pSpinBox;
+    }
+
+    auto pThis = const_cast<PropertyDelegate*>(this);
+    auto pSpinBox = new BigSpinBox(pParent);
+
+    // Every step is its own command, they merge together while they are close in time
+    connect(pSpinBox, &BigSpinBox::valueChanged, pThis, [pThis, pSpinBox](qint64, bool closeEditor)
+        {
+            emit pThis->commitData(pSpinBox);
+            if (closeEditor)
+            {
+                emit pThis->closeEditor(pSpinBox);
+            }
+        });
+    return pSpinBox;
+}
+
+QComboBox* PropertyDelegate::TakeComboBox(QWidget* pParent) const
+{
+    if (!mFreeComboBoxes.empty())
+    {
+        QComboBox* pCombo = mFreeComboBoxes.back();
+        mFreeComboBoxes.pop_back();
+        pCombo->setParent(pParent);
+        return pCombo;
+    }
+
+    auto pThis = const_cast<PropertyDelegate*>(this);
+    auto pCombo = new QComboBox(pParent);
+    connect(pCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), pThis, [pThis, pCombo](int)
+        {
+            emit pThis->commitData(pCombo);
+        });
+    return pCombo;
+}
+
+QStringListModel* PropertyDelegate::EnumValuesModel(const Enum& enumType) const
+{
+    QStringListModel*& pValuesModel = mEnumValuesModels[&enumType];
+    if (!pValuesModel)
+    {
+        QStringList values;
+        values.reserve(static_cast<int>(enumType.mValues.size()));
+        for (const std::string& value : enumType.mValues)
+        {
+            values.append(QString::fromStdString(value));
+        }
+
+        // Parented to the delegate rather than a combo box, a combo box deletes a model it owns when given another
+        pValuesModel = new QStringListModel(values, const_cast<PropertyDelegate*>(this));
+    }
+    return pValuesModel;
+}
+
+void PropertyDelegate::setEditorData(QWidget* pEditor, const QModelIndex& index) const
+{
+    // Mixed values start out empty and aren't committed until something is entered
+    const PropertyModel::Row& row = mTreeWidget->GetPropertyModel().RowAt(index.row());
+    switch (row.mKind)
+    {
+    case PropertyModel::RowKind::String:
+    {
+        auto pEdit = static_cast<QLineEdit*>(pEditor);
+        if (!pEdit->hasFocus())
+        {
+            pEdit->setText(row.Mixed() ? QString() : QString(row.mStrings.front()->c_str()));
+        }
+    }
+        break;
+
+    case PropertyModel::RowKind::BasicType:
+    {
+        auto pSpinBox = static_cast<BigSpinBox*>(pEditor);
+        if (row.Mixed())
+        {
+            pSpinBox->setMixed();
+        }
+        else
+        {
+            pSpinBox->setValue(row.mProperties.front()->mBasicTypeValue, false);
+        }
+    }
+        break;
+
+    case PropertyModel::RowKind::Enumeration:
+    {
+        // Setting it from the model isn't an edit
+        auto pCombo = static_cast<QComboBox*>(pEditor);
+        const QSignalBlocker blocker(pCombo);
+        pCombo->setCurrentIndex(row.Mixed() ? -1 : EnumIndexOf(*row.mEnum, row.mProperties.front()->mEnumValue));
+    }
+        break;
+
+    default:
+        QStyledItemDelegate::setEditorData(pEditor, index);
+        break;
+    }
+}
+
+void PropertyDelegate::setModelData(QWidget* pEditor, QAbstractItemModel* /*pModel*/, const QModelIndex& index) const
+{
+    const PropertyModel& propertyModel = mTreeWidget->GetPropertyModel();
+    const PropertyModel::Row& row = propertyModel.RowAt(index.row());
+    const std::vector<IGraphicsItem*>& graphicsItems = propertyModel.GraphicsItems();
+    QUndoStack* pUndoStack = mTreeWidget->UndoStack();
+    if (!pUndoStack)
+    {
+        return;
+    }
+
+    // One command for all of the selected items, nothing is pushed if none of them would change
+    switch (row.mKind)
+    {
+    case PropertyModel::RowKind::String:
+    {
+        const QString newValue = static_cast<QLineEdit*>(pEditor)->text();
+        std::vector<QString> oldValues;
+        bool changed = false;
+        for (const std::string* pString : row.mStrings)
+        {
+            oldValues.push_back(pString->c_str());
+            changed |= oldValues.back() != newValue;
+        }
+
+        if (!newValue.isEmpty() && changed)
+        {
+            pUndoStack->push(new ChangeStringPropertyCommand(mTreeWidget, row.mStrings, row.mFixedName, std::move(oldValues), newValue));
+        }
+    }
+        break;
+
+    case PropertyModel::RowKind::BasicType:
+    {
+        // The view commits on focus out too, a spin box that is still mixed has no value to give
+        auto pSpinBox = static_cast<BigSpinBox*>(pEditor);
+        if (pSpinBox->isMixed())
+        {
+            break;
+        }
+
+        const int newValue = static_cast<int>(pSpinBox->value());
+        std::vector<LinkedProperty> linkedProperties;
+        std::vector<int> oldValues;
+        bool changed = false;
+        for (size_t i = 0; i < row.mProperties.size(); i++)
+        {
+            linkedProperties.emplace_back(mTreeWidget, row.mProperties[i], graphicsItems[i]);
+            oldValues.push_back(row.mProperties[i]->mBasicTypeValue);
+            changed |= oldValues.back() != newValue;
+        }
+
+        if (changed)
+        {
+            pUndoStack->push(new ChangeBasicTypePropertyCommand(std::move(linkedProperties),
+                BasicTypePropertyChangeData(row.mBasicType, std::move(oldValues), newValue)));
+        }
+    }
+        break;
+
+    case PropertyModel::RowKind::Enumeration:
+    {
+        const int newIdx = static_cast<QComboBox*>(pEditor)->currentIndex();
+        if (newIdx == -1)
+        {
+            break;
+        }
+
+        // A value that isn't in the enum can't be put back on undo, so those are left alone
+        std::vector<LinkedProperty> linkedProperties;
+        std::vector<int> oldIdxs;
+        bool changed = false;
+        for (size_t i = 0; i < row.mProperties.size(); i++)
+        {
+            const int oldIdx = EnumIndexOf(*row.mEnum, row.mProperties[i]->mEnumValue);
+            if (oldIdx != -1)
+            {
+                linkedProperties.emplace_back(mTreeWidget, row.mProperties[i], graphicsItems[i]);
+                oldIdxs.push_back(oldIdx);
+                changed |= oldIdx != newIdx;
+            }
+        }
+
+        if (changed)
+        {
+            pUndoStack->push(new ChangeEnumPropertyCommand(std::move(linkedProperties),
+                EnumPropertyChangeData(row.mEnum, std::move(oldIdxs), newIdx)));
+        }
+    }
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QStyledItemDelegate>
+#include <QHash>
+#include <vector>
+
+class PropertyTreeWidget;
+class QLineEdit;
+class QComboBox;
+class QStringListModel;
+class BigSpinBox;
+struct Enum;
+
+// Makes the editor for a value in the property tree and turns a finished edit into the matching
+// change property undo command, the command then writes the model and refreshes the row
+class PropertyDelegate final : public QStyledItemDelegate
+{
+public:
+    explicit PropertyDelegate(PropertyTreeWidget* pTreeWidget);
+
+    QWidget* createEditor(QWidget* pParent, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    void setEditorData(QWidget* pEditor, const QModelIndex& index) const override;
+    void setModelData(QWidget* pEditor, QAbstractItemModel* pModel, const QModelIndex& index) const override;
+    void destroyEditor(QWidget* pEditor, const QModelIndex& index) const override;
+
+private:
+    QLineEdit* TakeLineEdit(QWidget* pParent) const;
+    BigSpinBox* TakeSpinBox(QWidget* pParent) const;
+    QComboBox* TakeComboBox(QWidget* pParent) const;
+    QStringListModel* EnumValuesModel(const Enum& enumType) const;
+
+    PropertyTreeWidget* mTreeWidget = nullptr;
+
+    // The values of each enum, made the first time one of its properties is edited and shared by
+    // every combo box after that. The enums belong to the tab's model so they outlive the delegate.
+    mutable QHash<const Enum*, QStringListModel*> mEnumValuesModels;
+
+    // Closed editors are hidden and kept here to be handed out again by createEditor
+    mutable std::vector<QLineEdit*> mFreeLineEdits;
+    mutable std::vector<BigSpinBox*> mFreeSpinBoxes;
+    mutable std::vector<QComboBox*> mFreeComboBoxes;
+};
@@ -0,0 +1,354 @@
+#include "PropertyModel.hpp"
+#include "PropertyTreeWidget.hpp"
+#include "ResizeableArrowItem.hpp"
+#include "ResizeableRectItem.hpp"
+#include <algorithm>
+#include <functional>
+
+// std::less because < isn't defined for pointers into different objects
+static bool KeyLess(const std::pair<const void*, int>& a, const std::pair<const void*, int>& b)
+{
+    return std::less<const void*>()(a.first, b.first);
+}
+
+bool PropertyModel::Row::Mixed() const
+{
+    switch (mKind)
+    {
+    case RowKind::String:
+        for (const std::string* pString : mStrings)
+        {
+            if (*pString != *mStrings.front())
+            {
+                return true;
+            }
+        }
+        return false;
+
+    case RowKind::BasicType:
+        for (const ObjectProperty* pProperty : mProperties)
+        {
+            if (pProperty->mBasicTypeValue != mProperties.front()->mBasicTypeValue)
+            {
+                return true;
+            }
+        }
+        return false;
+
+    case RowKind::Enumeration:
+        for (const ObjectProperty* pProperty : mProperties)
+        {
+            if (pProperty->mEnumValue != mProperties.front()->mEnumValue)
+            {
+                return true;
+            }
+        }
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+const void* PropertyModel::Row::Key() const
+{
+    switch (mKind)
+    {
+    case RowKind::String:
+        return mStrings.front();
+    case RowKind::ReadOnlyInt:
+        return mInt;
+    default:
+        return mProperties.front();
+    }
+}
+
+PropertyModel::Row& PropertyModel::NextRow()
+{
+    // Rows past mRowCount are kept from earlier selections so their vectors keep their capacity
+    if (mRowCount == mRows.size())
+    {
+        mRows.emplace_back();
+    }
+
+    Row& row = mRows[mRowCount++];
+    row.mKind = RowKind::String;
+    row.mFixedName = nullptr;
+    row.mStrings.clear();
+    row.mProperties.clear();
+    row.mInt = nullptr;
+    row.mBasicType = nullptr;
+    row.mEnum = nullptr;
+    return row;
+}
+
+void PropertyModel::Populate(Model& model, const QList<QGraphicsItem*>& items)
+{
+    beginResetModel();
+
+    // Everything is cleared rather than freed, clicking through objects fills them again with
+    // about as much as last time
+    mRowCount = 0;
+    mRowByKey.clear();
+    mGraphicsItems.clear();
+    mPropsPerItem.clear();
+
+    // The Name or Id row, dropped again below if there isn't one
+    Row& fixedRow = NextRow();
+    const MapObject* pFirstMapObject = nullptr;
+    for (QGraphicsItem* pItem : items)
+    {
+        auto pRect = qgraphicsitem_cast<ResizeableRectItem*>(pItem);
+        auto pLine = qgraphicsitem_cast<ResizeableArrowItem*>(pItem);
+        if (pRect && (mPropsPerItem.empty() || fixedRow.mStrings.size() == mPropsPerItem.size()))
+        {
+            // Different structures could have properties with the same name that mean different things
+            MapObject* pMapObject = pRect->GetMapObject();
+            if (!pFirstMapObject)
+            {
+                pFirstMapObject = pMapObject;
+            }
+            else if (pFirstMapObject->mObjectStructureType != pMapObject->mObjectStructureType)
+            {
+                mPropsPerItem.clear();
+                break;
+            }
+
+            mGraphicsItems.push_back(pRect);
+            mPropsPerItem.push_back(&pMapObject->mProperties);
+            fixedRow.mStrings.push_back(&pMapObject->mName);
+        }
+        else if (pLine && fixedRow.mStrings.empty())
+        {
+            CollisionObject* pCollisionItem = pLine->GetCollisionItem();
+            mGraphicsItems.push_back(pLine);
+            mPropsPerItem.push_back(&pCollisionItem->mProperties);
+            fixedRow.mInt = &pCollisionItem->mId;
+        }
+        else
+        {
+            // A mix of map objects and collisions have nothing in common
+            mPropsPerItem.clear();
+            break;
+        }
+    }
+
+    if (mPropsPerItem.empty())
+    {
+        mGraphicsItems.clear();
+        mRowCount = 0;
+    }
+    else
+    {
+        if (!fixedRow.mStrings.empty())
+        {
+            fixedRow.mKind = RowKind::String;
+            fixedRow.mFixedName = "Name";
+        }
+        else if (mPropsPerItem.size() == 1)
+        {
+            // Ids are unique so there is nothing to show for more than one
+            fixedRow.mKind = RowKind::ReadOnlyInt;
+            fixedRow.mFixedName = "Id";
+        }
+        else
+        {
+            mRowCount = 0;
+        }
+
+        AddProperties(model);
+    }
+
+    for (size_t i = 0; i < mRowCount; i++)
+    {
+        const Row& row = mRows[i];
+        if (row.mKind == RowKind::ReadOnlyInt)
+        {
+            mRowByKey.emplace_back(row.mInt, static_cast<int>(i));
+        }
+
+        for (const std::string* pString : row.mStrings)
+        {
+            mRowByKey.emplace_back(pString, static_cast<int>(i));
+        }
+
+        for (const ObjectProperty* pProperty : row.mProperties)
+        {
+            mRowByKey.emplace_back(pProperty, static_cast<int>(i));
+        }
+    }
+    std::sort(mRowByKey.begin(), mRowByKey.end(), KeyLess);
+
+    endResetModel();
+}
+
+void PropertyModel::Clear()
+{
+    if (mRowCount == 0 && mGraphicsItems.empty())
+    {
+        return;
+    }
+
+    beginResetModel();
+    mRowCount = 0;
+    mRowByKey.clear();
+    mGraphicsItems.clear();
+    endResetModel();
+}
+
+void PropertyModel::AddProperties(Model& model)
+{
+    const std::vector<UP_ObjectProperty>& firstProps = *mPropsPerItem.front();
+    for (size_t propertyIdx = 0; propertyIdx < firstProps.size(); propertyIdx++)
+    {
+        ObjectProperty* pProperty = firstProps[propertyIdx].get();
+        if (!pProperty->mVisible)
+        {
+            continue;
+        }
+
+        // Only the properties every item has, matched by name and type
+        Row& row = NextRow();
+        row.mProperties.push_back(pProperty);
+        for (size_t i = 1; i < mPropsPerItem.size(); i++)
+        {
+            // Items of the same structure list their properties in the same order, so the same
+            // position nearly always has it and the search by name is only a fallback
+            std::vector<UP_ObjectProperty>& otherProps = *mPropsPerItem[i];
+            ObjectProperty* pOther = propertyIdx < otherProps.size() && otherProps[propertyIdx]->mName == pProperty->mName ? otherProps[propertyIdx].get() : PropertyByName(pProperty->mName, otherProps);
+            if (!pOther || pOther->mType != pProperty->mType || pOther->mTypeName != pProperty->mTypeName)
+            {
+                break;
+            }
+            row.mProperties.push_back(pOther);
+        }
+
+        if (row.mProperties.size() != mPropsPerItem.size())
+        {
+            mRowCount--;
+            continue;
+        }
+
+        switch (pProperty->mType)
+        {
+        case ObjectProperty::Type::BasicType:
+            row.mKind = RowKind::BasicType;
+            row.mBasicType = model.FindBasicType(pProperty->mTypeName);
+            break;
+
+        case ObjectProperty::Type::Enumeration:
+            row.mKind = RowKind::Enumeration;
+            row.mEnum = model.FindEnum(pProperty->mTypeName);
+            break;
+        }
+    }
+}
+
+void PropertyModel::PropertyChanged(const void* pKey)
+{
+    auto it = std::lower_bound(mRowByKey.begin(), mRowByKey.end(), std::make_pair(pKey, 0), KeyLess);
+    if (it != mRowByKey.end() && it->first == pKey)
+    {
+        const QModelIndex changed = index(it->second, 1);
+        emit dataChanged(changed, changed);
+    }
+}
+
+void PropertyModel::AllPropertiesChanged(IGraphicsItem* pItem)
+{
+    if (std::find(mGraphicsItems.begin(), mGraphicsItems.end(), pItem) != mGraphicsItems.end())
+    {
+        AllPropertiesChanged();
+    }
+}
+
+void PropertyModel::AllPropertiesChanged()
+{
+    if (mRowCount == 0)
+    {
+        return;
+    }
+
+    // One range for the whole value column, the view only repaints the rows it shows
+    emit dataChanged(index(0, 1), index(static_cast<int>(mRowCount) - 1, 1));
+}
+
+QModelIndex PropertyModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (parent.isValid() || row < 0 || row >= static_cast<int>(mRowCount) || column < 0 || column > 1)
+    {
+        return QModelIndex();
+    }
+    return createIndex(row, column);
+}
+
+QModelIndex PropertyModel::parent(const QModelIndex&) const
+{
+    return QModelIndex();
+}
+
+int PropertyModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(mRowCount);
+}
+
+int PropertyModel::columnCount(const QModelIndex&) const
+{
+    return 2;
+}
+
+QVariant PropertyModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+    {
+        return QVariant();
+    }
+
+    const Row& row = mRows[index.row()];
+    if (index.column() == 0)
+    {
+        return kIndent + (row.mFixedName ? QString(row.mFixedName) : QString::fromStdString(row.mProperties.front()->mName));
+    }
+
+    if (row.Mixed())
+    {
+        return role == Qt::DisplayRole ? QVariant(QString(QChar(0x2014))) : QVariant();
+    }
+
+    switch (row.mKind)
+    {
+    case RowKind::String:
+        return QString::fromStdString(*row.mStrings.front());
+    case RowKind::ReadOnlyInt:
+        return *row.mInt;
+    case RowKind::BasicType:
+        return row.mProperties.front()->mBasicTypeValue;
+    case RowKind::Enumeration:
+        return QString::fromStdString(row.mProperties.front()->mEnumValue);
+    }
+    return QVariant();
+}
+
+QVariant PropertyModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    {
+        return QVariant();
+    }
+    return section == 0 ? QString("Property") : QString("Value");
+}
+
+Qt::ItemFlags PropertyModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid())
+    {
+        return Qt::NoItemFlags;
+    }
+
+    Qt::ItemFlags itemFlags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if (index.column() == 1 && mRows[index.row()].mKind != RowKind::ReadOnlyInt)
+    {
+        itemFlags |= Qt::ItemIsEditable;
+    }
+    return itemFlags;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QList>
+#include <utility>
+#include <vector>
+#include "Model.hpp"
+
+class IGraphicsItem;
+class QGraphicsItem;
+
+// Two columns, property and value, over the properties of the selected map objects or collisions.
+// The rows point straight at the properties in the model so changing the selection only swaps
+// the pointers, and a changed value is a dataChanged for its row. With more than one item selected
+// only the properties they all have are shown, along with a placeholder where their values differ.
+class PropertyModel final : public QAbstractItemModel
+{
+public:
+    using QAbstractItemModel::QAbstractItemModel;
+
+    enum class RowKind
+    {
+        String,
+        ReadOnlyInt,
+        BasicType,
+        Enumeration,
+    };
+
+    struct Row final
+    {
+        RowKind mKind = RowKind::String;
+
+        // For the rows that aren't an ObjectProperty, e.g. "Name" and "Id"
+        const char* mFixedName = nullptr;
+
+        // One per selected item, in the same order as GraphicsItems()
+        std::vector<std::string*> mStrings;
+        std::vector<ObjectProperty*> mProperties;
+
+        // Only shown for a single item
+        int* mInt = nullptr;
+
+        BasicType* mBasicType = nullptr;
+        Enum* mEnum = nullptr;
+
+        // True when the selected items don't all have the same value
+        bool Mixed() const;
+
+        // What the change property commands refresh by, the first item's value
+        const void* Key() const;
+    };
+
+    // Shows nothing unless the items are all map objects of the same structure or all collisions
+    void Populate(Model& model, const QList<QGraphicsItem*>& items);
+    void Clear();
+
+    const Row& RowAt(int row) const
+    {
+        return mRows[row];
+    }
+
+    const std::vector<IGraphicsItem*>& GraphicsItems() const
+    {
+        return mGraphicsItems;
+    }
+
+    // The value of one property changed, does nothing if it isn't shown
+    void PropertyChanged(const void* pKey);
+
+    // Any of the values of the item might have changed, does nothing if it isn't one of the shown ones
+    void AllPropertiesChanged(IGraphicsItem* pItem);
+
+    // Any of the shown values might have changed
+    void AllPropertiesChanged();
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& index) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+private:
+    Row& NextRow();
+    void AddProperties(Model& model);
+
+    // Only the first mRowCount are shown, the rest are reused by the next Populate
+    std::vector<Row> mRows;
+    size_t mRowCount = 0;
+
+    // Every item's value points at its row so a command for any of them finds it. Sorted by the
+    // value's address and found with a binary search, clearing it keeps its capacity so a
+    // selection change doesn't allocate once it has held as many values before.
+    std::vector<std::pair<const void*, int>> mRowByKey;
+    std::vector<IGraphicsItem*> mGraphicsItems;
+    std::vector<std::vector<UP_ObjectProperty>*> mPropsPerItem;
+};
@@ -1,69 +1,34 @@
 #include "PropertyTreeWidget.hpp"
-#include "PropertyTreeItemBase.hpp"
-#include "Model.hpp"
-#include "ResizeableArrowItem.hpp"
-#include "ResizeableRectItem.hpp"
-#include "StringProperty.hpp"
-#include "BasicTypeProperty.hpp"
-#include "EnumProperty.hpp"
+#include "PropertyModel.hpp"
+#include "PropertyDelegate.hpp"
 #include <QHeaderView>
 
-PropertyTreeItemBase* PropertyTreeWidget::FindObjectPropertyByKey(const void* pKey)
+PropertyTreeWidget::PropertyTreeWidget(QWidget* pParent)
+    : QTreeView(pParent)
 {
-    for (int i = 0; i < topLevelItemCount(); i++)
-    {
-        auto pItem = static_cast<PropertyTreeItemBase*>(topLevelItem(i));
-        const void* itemKey = pItem->GetPropertyLookUpKey();
-        if (itemKey == pKey)
-        {
-            return pItem;
-        }
-    }
-    return nullptr;
+    mPropertyModel = new PropertyModel(this);
+    setModel(mPropertyModel);
+    setItemDelegate(new PropertyDelegate(this));
 }
 
-void PropertyTreeWidget::Populate(Model& model, QUndoStack& undoStack, QGraphicsItem* pItem)
+void PropertyTreeWidget::RefreshProperty(const void* pKey)
 {
-    auto pLine = qgraphicsitem_cast<ResizeableArrowItem*>(pItem);
-    auto pRect = qgraphicsitem_cast<ResizeableRectItem*>(pItem);
-
-    QList<QTreeWidgetItem*> items;
-    QTreeWidgetItem* parent = nullptr;
-    if (pRect)
-    {
-        MapObject* pMapObject = pRect->GetMapObject();
-
-        items.append(new StringProperty(undoStack, parent, kIndent + "Name", &pMapObject->mName));
-        AddProperties(model, undoStack, items, pMapObject->mProperties, pRect);
-    }
-    else if (pLine)
-    {
-        CollisionObject* pCollisionItem = pLine->GetCollisionItem();
-
-        items.append(new ReadOnlyStringProperty(parent, kIndent + "Id", &pCollisionItem->mId));
-
-        AddProperties(model, undoStack, items, pCollisionItem->mProperties, pLine);
-    }
+    mPropertyModel->PropertyChanged(pKey);
+}
 
-    insertTopLevelItems(0, items);
+void PropertyTreeWidget::Populate(Model& model, QUndoStack& undoStack, const QList<QGraphicsItem*>& items)
+{
+    mUndoStack = &undoStack;
+    mPropertyModel->Populate(model, items);
 }
 
 void PropertyTreeWidget::DePopulate()
 {
-    clear();
+    mPropertyModel->Clear();
 }
 
 void PropertyTreeWidget::Init()
 {
-    // Two columns, property and value
-    setColumnCount(2);
-
-    // Set the header text
-    QStringList headerStrings;
-    headerStrings.append("Property");
-    headerStrings.append("Value");
-    setHeaderLabels(headerStrings);
-
     setAlternatingRowColors(true);
     setStyleSheet("QTreeView::item { height:23px; font:6px; padding:0px; margin:0px; }");
 
@@ -74,66 +39,36 @@ void PropertyTreeWidget::Init()
 
     setRootIsDecorated(false);
 
-    connect(this, &QTreeWidget::itemClicked, this, [&](QTreeWidgetItem* current, int col)
+    // The editor opens as soon as a value is clicked or its row becomes current, like the
+    // widgets the tree used to put in every row
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    connect(this, &QTreeView::clicked, this, [&](const QModelIndex& index)
         {
-            if (current && col == 1)
+            if (index.column() == 1)
             {
-                if (!itemWidget(current, 1))
-                {
-                    setItemWidget(current, 1, static_cast<PropertyTreeItemBase*>(current)->CreateEditorWidget(this));
-                }
+                EditValue(index);
             }
         });
-    connect(this, &QTreeWidget::currentItemChanged, this, [&](QTreeWidgetItem* current, QTreeWidgetItem* prev)
+    connect(selectionModel(), &QItemSelectionModel::currentRowChanged, this, [&](const QModelIndex& current, const QModelIndex&)
         {
-            if (prev)
+            if (current.isValid())
             {
-                setItemWidget(prev, 1, nullptr);
-            }
-
-            if (current)
-            {
-                setItemWidget(current, 1, static_cast<PropertyTreeItemBase*>(current)->CreateEditorWidget(this));
+                EditValue(current.sibling(current.row(), 1));
             }
         });
 }
 
-void PropertyTreeWidget::Sync(IGraphicsItem* pItem)
+void PropertyTreeWidget::EditValue(const QModelIndex& index)
 {
-    auto& props = pItem->GetProperties();
-    for (auto& prop : props)
+    // Qt warns about editing a read only value
+    if (index.flags() & Qt::ItemIsEditable)
     {
-        PropertyTreeItemBase* pTreeItem = FindObjectPropertyByKey(prop.get());
-        if (pTreeItem)
-        {
-            pTreeItem->Refresh();
-        }
+        QAbstractItemView::edit(index);
     }
 }
 
-void PropertyTreeWidget::AddProperties(Model& model, QUndoStack& undoStack, QList<QTreeWidgetItem*>& items, std::vector<UP_ObjectProperty>& props, IGraphicsItem* pGraphicsItem)
+void PropertyTreeWidget::Sync(IGraphicsItem* pItem)
 {
-    QTreeWidgetItem* parent = nullptr;
-    for (UP_ObjectProperty& property : props)
-    {
-        if (property->mVisible)
-        {
-            switch (property->mType)
-            {
-            case ObjectProperty::Type::BasicType:
-            {
-                BasicType* pBasicType = model.FindBasicType(property->mTypeName);
-                items.append(new BasicTypeProperty(undoStack, parent, kIndent + property->mName.c_str(), property.get(), pGraphicsItem, pBasicType));
-            }
-                break;
-
-            case ObjectProperty::Type::Enumeration:
-            {
-                Enum* pEnum = model.FindEnum(property->mTypeName);
-                items.append(new EnumProperty(undoStack, parent, property.get(), pGraphicsItem, pEnum));
-            }
-                break;
-            }
-        }
-    }
+    // Every moved item calls this but only the ones being shown have anything to refresh
+    mPropertyModel->AllPropertiesChanged(pItem);
 }
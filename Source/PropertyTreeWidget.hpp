@@ -1,14 +1,13 @@
 #pragma once
 
-#include <QTreeWidget>
+#include <QTreeView>
 #include "Model.hpp"
 
-class PropertyTreeItemBase;
 class IGraphicsItem;
-struct MapObject;
-class CollisionObject;
 class QGraphicsItem;
 class QUndoStack;
+class PropertyModel;
+class PropertyTreeWidget;
 
 
 inline const QString kIndent("    ");
@@ -20,21 +19,46 @@ public:
     virtual void Sync(IGraphicsItem* pItem) = 0;
 };
 
+// What a change property command needs to write the property and show the new value
+struct LinkedProperty
+{
+    LinkedProperty(PropertyTreeWidget* pTreeWidget, ObjectProperty* pProperty, IGraphicsItem* pGraphicsItem)
+        : mTreeWidget(pTreeWidget), mProperty(pProperty), mGraphicsItem(pGraphicsItem)
+    {
+
+    }
+    PropertyTreeWidget* mTreeWidget = nullptr;
+    ObjectProperty* mProperty = nullptr;
+    IGraphicsItem* mGraphicsItem = nullptr;
+};
 
-class PropertyTreeWidget : public ISyncPropertiesToTree, public QTreeWidget
+class PropertyTreeWidget : public ISyncPropertiesToTree, public QTreeView
 {
 public:
-    using QTreeWidget::QTreeWidget;
+    explicit PropertyTreeWidget(QWidget* pParent = nullptr);
 
-    PropertyTreeItemBase* FindObjectPropertyByKey(const void* pKey);
+    // Refreshes the property if it's currently shown, undo and redo can happen for any object
+    void RefreshProperty(const void* pKey);
 
-    void Populate(Model& model, QUndoStack& undoStack, QGraphicsItem* pItem);
+    void Populate(Model& model, QUndoStack& undoStack, const QList<QGraphicsItem*>& items);
     void DePopulate();
 
     void Init();
 
+    PropertyModel& GetPropertyModel() const
+    {
+        return *mPropertyModel;
+    }
+
+    QUndoStack* UndoStack() const
+    {
+        return mUndoStack;
+    }
+
 private:
     void Sync(IGraphicsItem* pItem) override;
-    void AddProperties(Model& model, QUndoStack& undoStack, QList<QTreeWidgetItem*>& items, std::vector<UP_ObjectProperty>& props, IGraphicsItem* pGraphicsItem);
+    void EditValue(const QModelIndex& index);
 
+    PropertyModel* mPropertyModel = nullptr;
+    QUndoStack* mUndoStack = nullptr;
 };
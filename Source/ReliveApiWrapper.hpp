@@ -3,6 +3,9 @@
 #include "relive_api.hpp"
 #include "file_api.hpp"
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <cstring>
 #include <QString>
 
 // Implement ReliveAPI::IFileIO override that supports unicode from utf8 on windows
@@ -148,6 +151,105 @@ public:
     }
 };
 
+// Read only view of a file that is already in memory, each one has its own position so
+// many can share the same data
+class MemoryFile final : public ReliveAPI::IFile
+{
+public:
+    explicit MemoryFile(std::shared_ptr<const std::string> data)
+        : mData(std::move(data))
+    {
+
+    }
+
+    bool IsOpen() const override
+    {
+        return mData != nullptr;
+    }
+
+    bool Seek(std::size_t absPos) override
+    {
+        if (absPos > mData->size())
+        {
+            return false;
+        }
+        mPos = absPos;
+        return true;
+    }
+
+    bool Read(u8* buffer, std::size_t len) override
+    {
+        if (len > mData->size() - mPos)
+        {
+            return false;
+        }
+        std::memcpy(buffer, mData->data() + mPos, len);
+        mPos += len;
+        return true;
+    }
+
+    bool Write(const u8* /*buffer*/, std::size_t /*len*/) override
+    {
+        return false;
+    }
+
+    bool ReadInto(std::string& str) override
+    {
+        str.assign(mData->data() + mPos, mData->size() - mPos);
+        mPos = mData->size();
+        return true;
+    }
+
+    bool PadEOF(u32 /*multiple*/) override
+    {
+        return false;
+    }
+
+private:
+    std::shared_ptr<const std::string> mData;
+    std::size_t mPos = 0;
+};
+
+// Loads one LVL into memory the first time it is opened so that opening it many times, from
+// many threads at once, only reads it from the disk once. Every other file goes to EditorFileIO.
+class CachedLvlFileIO final : public ReliveAPI::IFileIO
+{
+public:
+    explicit CachedLvlFileIO(const std::string& lvlFileName)
+        : mLvlFileName(lvlFileName)
+    {
+
+    }
+
+    std::unique_ptr<ReliveAPI::IFile> Open(const std::string& fileName, ReliveAPI::IFileIO::Mode mode) override
+    {
+        if (mode == ReliveAPI::IFileIO::Mode::ReadBinary && fileName == mLvlFileName)
+        {
+            std::call_once(mLoadOnce, [this]()
+                {
+                    File file(mLvlFileName, ReliveAPI::IFileIO::Mode::ReadBinary);
+                    auto data = std::make_shared<std::string>();
+                    if (file.IsOpen() && file.ReadInto(*data))
+                    {
+                        mLvlData = data;
+                    }
+                });
+
+            if (mLvlData)
+            {
+                return std::make_unique<MemoryFile>(mLvlData);
+            }
+        }
+        return mFileIO.Open(fileName, mode);
+    }
+
+private:
+    std::string mLvlFileName;
+    std::once_flag mLoadOnce;
+    std::shared_ptr<const std::string> mLvlData;
+    EditorFileIO mFileIO;
+};
+
 // TODO: Add more context to each of these errors
 template<typename ApiCall>
 bool ExecApiCall(ApiCall apiCall, std::function<void(const QString)> onFailure)
@@ -7,27 +7,37 @@
 #include "Model.hpp"
 #include "PropertyTreeWidget.hpp"
 #include "SnapSettings.hpp"
+#include "EditorGraphicsScene.hpp"
+#include "EditorGraphicsView.hpp"
+#include "PaintProfiler.hpp"
 
-ResizeableArrowItem::ResizeableArrowItem(QGraphicsView* pView, CollisionObject* pLine, ISyncPropertiesToTree& propSyncer, int transparency, SnapSettings& snapSettings, IPointSnapper& snapper)
+ResizeableArrowItem::ResizeableArrowItem(QGraphicsView* pView, CollisionObject* pLine, ISyncPropertiesToTree& propSyncer, SnapSettings& snapSettings, IPointSnapper& snapper)
     : QGraphicsLineItem(pLine->X2(), pLine->Y2(), pLine->X1(), pLine->Y1()), mView(pView), mLine(pLine), mPropSyncer(propSyncer), mSnapSettings(snapSettings), mSnapper(snapper)
 {
     Init();
+    UpdateBrush();
     setZValue(2.0);
-    SetTransparency(this, transparency);
 }
 
-void ResizeableArrowItem::hoverLeaveEvent( QGraphicsSceneHoverEvent* aEvent )
+void ResizeableArrowItem::HoverEnter()
 {
+    mHovered = true;
+    update();
+}
+
+void ResizeableArrowItem::HoverLeave()
+{
+    mHovered = false;
+    update();
     SetViewCursor( Qt::ArrowCursor );
-    QGraphicsItem::hoverLeaveEvent( aEvent );
 }
 
-void ResizeableArrowItem::hoverMoveEvent( QGraphicsSceneHoverEvent* aEvent )
+void ResizeableArrowItem::HoverMove( const QPointF& itemPos, Qt::KeyboardModifiers modifiers )
 {
     if ( !m_MouseIsDown )
     {
         m_MouseDownLine = line();
-        CalcWhichEndOfLineClicked( aEvent->pos(), aEvent->modifiers() );
+        CalcWhichEndOfLineClicked( itemPos, modifiers );
         if ( m_endOfLineClicked == eLinePoints_None )
         {
             SetViewCursor( Qt::OpenHandCursor );
@@ -36,9 +46,7 @@ void ResizeableArrowItem::hoverMoveEvent( QGraphicsSceneHoverEvent* aEvent )
         {
             SetViewCursor( Qt::CrossCursor );
         }
-        return;
     }
-    QGraphicsItem::hoverMoveEvent( aEvent );
 }
 
 void ResizeableArrowItem::mousePressEvent( QGraphicsSceneMouseEvent* aEvent )
@@ -117,70 +125,108 @@ void ResizeableArrowItem::paint( QPainter* aPainter, const QStyleOptionGraphicsI
 {
     Q_UNUSED( aWidget );
 
+    // The batched layer draws it unless it's being edited, those empty paints aren't profiled
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if ( pScene && pScene->BatchedRendering() && !isSelected() && !mHovered )
+    {
+        return;
+    }
+
+    PAINT_PROFILE_SCOPE(Collision);
+
+    // The item cache keeps what's drawn now without antialiasing, it has to be redrawn once the view stops moving
+    if ( pScene && pScene->DraftRendering() )
+    {
+        pScene->DraftPainted( this );
+    }
+
     // Only draw what is required
     aPainter->setClipRect( aOption->exposedRect );
-    std::string prop_id = PropertyByName("Type",mLine->mProperties)->mEnumValue;
-    
+    aPainter->setBrush( mBrush );
+
+    // Change the pen depending on selection
+    if ( isSelected() )
+    {
+        aPainter->setPen( QPen ( Qt::red, 2, Qt::DashLine )  );
+    }
+    else
+    {
+        QPen p( Qt::black, 2, Qt::SolidLine );
+        p.setJoinStyle( Qt::RoundJoin );
+        aPainter->setPen( p );
+    }
+
+    // Use the painter path for rendering
+    aPainter->drawPath( shape() );
+}
+
+void ResizeableArrowItem::UpdateBrush()
+{
+    const std::string prop_id = PropertyByName("Type", mLine->mProperties)->mEnumValue;
+
     if(prop_id == "Art")
     {
-        aPainter->setBrush( QColor(100, 100, 100, 255) );
+        mBrush = QColor(100, 100, 100, 255);
     }
     else if(prop_id.find("Background") != std::string::npos)
     {
-        aPainter->setBrush( QColor(150, 150, 75, 255) );
+        mBrush = QColor(150, 150, 75, 255);
     }
     else if(prop_id == "Bullet Wall")
     {
-        aPainter->setBrush( QColor(255, 70, 70, 255) );
+        mBrush = QColor(255, 70, 70, 255);
     }
     else if(prop_id.find("Flying Slig") != std::string::npos)
     {
-        aPainter->setBrush( QColor(30, 200, 15, 255) );
+        mBrush = QColor(30, 200, 15, 255);
     }
     else if(prop_id.find("Mine Car") != std::string::npos)
     {
-        aPainter->setBrush( QColor(190, 70, 255, 255) );
+        mBrush = QColor(190, 70, 255, 255);
     }
     else if(prop_id == "Track Line")
     {
-        aPainter->setBrush( QColor(0, 215, 215, 255) );
+        mBrush = QColor(0, 215, 215, 255);
     }
     else
     {
-        aPainter->setBrush( QColor(255, 255, 100, 255) );
+        mBrush = QColor(255, 255, 100, 255);
     }
-
-    // Change the pen depending on selection
-    if ( isSelected() )
-    {
-        aPainter->setPen( QPen ( Qt::red, 2, Qt::DashLine )  );
-    }
-    else
-    {
-        QPen p( Qt::black, 2, Qt::SolidLine );
-        p.setJoinStyle( Qt::RoundJoin );
-        aPainter->setPen( p );
-    }
-
-    // Use the painter path for rendering
-    aPainter->drawPath( shape() );
 }
 
-QPainterPath ResizeableArrowItem::shape() const
+void ResizeableArrowItem::CalcArrowHead(const QLineF& line, QLineF& head1, QLineF& head2)
 {
-    // Calc arrow head lines based on the angle of the current line
-    QLineF cLine = line();
-
     const auto kArrowHeadLength = 8;
     const auto kArrowHeadAngle = 32;
 
-    const qreal cLineAngle = cLine.angle();
-    QLineF head1 = cLine;
-    QLineF head2 = cLine;
+    const qreal cLineAngle = line.angle();
+    head1 = line;
+    head2 = line;
     head1.setLength( kArrowHeadLength );
     head1.setAngle( cLineAngle+-kArrowHeadAngle );
     head2.setLength( kArrowHeadLength );
     head2.setAngle( cLineAngle+kArrowHeadAngle );
+}
+
+QPainterPath ResizeableArrowItem::shape() const
+{
+    UpdateCachedShape();
+    return mCachedShape;
+}
+
+void ResizeableArrowItem::UpdateCachedShape() const
+{
+    if (mCachedShapeValid && mCachedShapeLine == line())
+    {
+        return;
+    }
+
+    // Calc arrow head lines based on the angle of the current line
+    QLineF cLine = line();
+
+    QLineF head1;
+    QLineF head2;
+    CalcArrowHead( cLine, head1, head2 );
 
     // Create paths for each section of the arrow
     QPainterPath mainLine;
@@ -204,18 +250,19 @@ QPainterPath ResizeableArrowItem::shape() const
     stroke.addPath( stroker.createStroke( headLine1 ) );
     stroke.addPath( stroker.createStroke( headLine2 ) );
 
-    return stroke.simplified();
+    mCachedShape = stroke.simplified();
+
+    QRectF bRect = mCachedShape.controlPointRect();
+    mCachedBoundingRect = QRectF( bRect.x()-1, bRect.y()-1, bRect.width()+2, bRect.height()+2 );
+
+    mCachedShapeLine = cLine;
+    mCachedShapeValid = true;
 }
 
 QRectF ResizeableArrowItem::boundingRect() const
 {
-    QPainterPath pPath = shape();
-
-    QRectF bRect = pPath.controlPointRect();
-
-    QRectF adjusted( bRect.x()-1, bRect.y()-1, bRect.width()+2, bRect.height()+2 );
-
-    return adjusted;
+    UpdateCachedShape();
+    return mCachedBoundingRect;
 }
 
 QVariant ResizeableArrowItem::itemChange(GraphicsItemChange aChange, const QVariant& aValue)
@@ -224,6 +271,11 @@ QVariant ResizeableArrowItem::itemChange(GraphicsItemChange aChange, const QVari
     {
         PosOrLineChanged();
     }
+    else if (aChange == ItemSceneChange || aChange == ItemSceneHasChanged || aChange == ItemSelectedHasChanged)
+    {
+        // Leaving the scene, joining it or being selected all change what the batched layer draws
+        InvalidateBatchedLayers();
+    }
     return QGraphicsLineItem::itemChange(aChange, aValue);
 }
 
@@ -235,10 +287,6 @@ void ResizeableArrowItem::Init()
     p.setJoinStyle( Qt::RoundJoin );
     setPen( p );
 
-    setAcceptHoverEvents( true );
-
-    SetViewCursor( Qt::CrossCursor );
-
     // Allow select and move.
     setFlags( ItemSendsScenePositionChanges | ItemSendsGeometryChanges | ItemIsMovable | ItemIsSelectable );
 
@@ -284,7 +332,7 @@ void ResizeableArrowItem::CalcWhichEndOfLineClicked( QPointF aPos, Qt::KeyboardM
 
 void ResizeableArrowItem::SetViewCursor(Qt::CursorShape cursor)
 {
-    mView->setCursor(cursor);
+    static_cast<EditorGraphicsView*>(mView)->SetCursorShape(cursor);
 }
 
 QLineF ResizeableArrowItem::SaveLine() const
@@ -301,9 +349,54 @@ void ResizeableArrowItem::RestoreLine(const QLineF& line)
 void ResizeableArrowItem::SyncToCollisionItem()
 {
     setLine(mLine->X2(), mLine->Y2(), mLine->X1(), mLine->Y1());
+
+    // The type might be what changed
+    UpdateBrush();
+    update();
+    GeometryChanged();
+}
+
+void ResizeableArrowItem::GeometryChanged()
+{
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene)
+    {
+        pScene->ItemGeometryChanged(this);
+    }
+}
+
+void ResizeableArrowItem::InvalidateBatchedLayers()
+{
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene)
+    {
+        pScene->InvalidateBatchedItem(this);
+    }
 }
 
 void ResizeableArrowItem::PosOrLineChanged()
+{
+    GeometryChanged();
+
+    // A drag can move hundreds of items per mouse move, the scene syncs them all once per frame instead
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene && pScene->Dragging())
+    {
+        pScene->QueueModelSync(this);
+        return;
+    }
+    SyncModelAndPropertyTree();
+}
+
+void ResizeableArrowItem::SyncModelAndPropertyTree()
+{
+    SyncModel();
+
+    // Update the property tree view
+    mPropSyncer.Sync(this);
+}
+
+void ResizeableArrowItem::SyncModel()
 {
     QLineF curLine = line();
 
@@ -314,7 +407,4 @@ void ResizeableArrowItem::PosOrLineChanged()
     mLine->SetY2(static_cast<int>(curLine.y1()));
 
     mLine->CalculateLength();
-
-    // Update the property tree view
-    mPropSyncer.Sync(this);
 }
\ No newline at end of file
@@ -12,12 +12,16 @@ class IPointSnapper;
 class ResizeableArrowItem final : public IGraphicsItem, public QGraphicsLineItem
 {
 public:
-    ResizeableArrowItem(QGraphicsView* pView, CollisionObject* pLine, ISyncPropertiesToTree& propSyncer, int transparency, SnapSettings& snapSettings, IPointSnapper& snapper);
+    ResizeableArrowItem(QGraphicsView* pView, CollisionObject* pLine, ISyncPropertiesToTree& propSyncer, SnapSettings& snapSettings, IPointSnapper& snapper);
     enum { Type = UserType + 2 };
     int type() const override { return Type; }
     QLineF SaveLine() const;
     void RestoreLine(const QLineF& line);
     CollisionObject* GetCollisionItem() const { return mLine; }
+    const QBrush& Brush() const { return mBrush; }
+
+    // The 2 short lines of the arrow head at p1 of line
+    static void CalcArrowHead(const QLineF& line, QLineF& head1, QLineF& head2);
 
     void SyncInternalObject() override
     {
@@ -29,9 +33,18 @@ public:
         return mLine->mProperties;
     }
 
+    // Writes the line to the collision and refreshes the property tree
+    void SyncModelAndPropertyTree();
+
+    // Only the collision, for when the property tree is refreshed once for many items
+    void SyncModel();
+
+    // Called by the scene, which finds the hovered item through its spatial index instead of Qt's hover events
+    void HoverEnter();
+    void HoverMove( const QPointF& itemPos, Qt::KeyboardModifiers modifiers );
+    void HoverLeave();
+
 protected:
-    void hoverLeaveEvent( QGraphicsSceneHoverEvent* aEvent ) override;
-    void hoverMoveEvent( QGraphicsSceneHoverEvent* aEvent ) override;
     void mousePressEvent( QGraphicsSceneMouseEvent* aEvent ) override;
     void mouseMoveEvent( QGraphicsSceneMouseEvent* aEvent ) override;
     void mouseReleaseEvent( QGraphicsSceneMouseEvent* aEvent ) override;
@@ -45,6 +58,10 @@ private:
     void SetViewCursor(Qt::CursorShape cursor);
     void SyncToCollisionItem();
     void PosOrLineChanged();
+    void UpdateBrush();
+    void GeometryChanged();
+    void InvalidateBatchedLayers();
+    void UpdateCachedShape() const;
 private:
     // For knowing which end to anchor line if required.
     enum eLinePoints
@@ -57,10 +74,21 @@ private:
     QPointF m_AnchorPoint;
     QLineF m_MouseDownLine;
     bool m_MouseIsDown = false;
+    bool mHovered = false;
     QGraphicsView* mView = nullptr;
     CollisionObject* mLine = nullptr;
     ISyncPropertiesToTree& mPropSyncer;
 
     SnapSettings& mSnapSettings;
     IPointSnapper& mSnapper;
+
+    // Stroking the arrow is expensive and shape()/boundingRect() are called constantly,
+    // so only redo it when the line is different to the one it was made from
+    mutable QLineF mCachedShapeLine;
+    mutable QPainterPath mCachedShape;
+    mutable QRectF mCachedBoundingRect;
+    mutable bool mCachedShapeValid = false;
+
+    // Depends on the collision "Type" so only changes when the properties are synced
+    QBrush mBrush;
 };
@@ -9,22 +9,110 @@
 #include <QStyleOptionGraphicsItem>
 #include <QGraphicsScene>
 #include <QGraphicsView>
-#include <QPixmapCache>
+#include <QTextLayout>
+#include <QHash>
+#include <memory>
 #include "Model.hpp"
 #include "PropertyTreeWidget.hpp"
 #include "SnapSettings.hpp"
+#include "EditorGraphicsScene.hpp"
+#include "EditorGraphicsView.hpp"
+#include "PaintProfiler.hpp"
+#include "ObjectIconAtlas.hpp"
 
 const quint32 ResizeableRectItem::kMinRectSize = 10;
 
-ResizeableRectItem::ResizeableRectItem(QGraphicsView* pView, MapObject* pMapObject, ISyncPropertiesToTree& propSyncer, int transparency, SnapSettings& snapSettings, IPointSnapper& snapper)
+// Below this many pixels on screen the object name can't be read so don't bother drawing it
+const qreal kMinReadableTextHeight = 4.0;
+
+// Resizing an object makes a new entry for every size it passes through, so start over when it gets this big
+const int kMaxCachedNameLayouts = 4096;
+
+struct ObjectNameLayout final
+{
+    int mPointSize = 0;
+    std::shared_ptr<QTextLayout> mLayout;
+
+    // Centers the wrapped text in the rect
+    QPointF mOffset;
+};
+
+// Finding the biggest font that fits the name in the rect means measuring the text several times,
+// which is far too slow to do on every paint so keep the result for each name and size. The font
+// and the DPI of what's painted on are part of the key so a change to either measures again.
+static const ObjectNameLayout& GetObjectNameLayout(const QFont& baseFont, QPaintDevice* pDevice, const QString& objectName, int width, int height)
+{
+    static QHash<QString, ObjectNameLayout> cache;
+
+    const int dpi = pDevice ? pDevice->logicalDpiY() : 0;
+    const QString key = objectName + "|" + QString::number(width) + "|" + QString::number(height) + "|" + baseFont.key() + "|" + QString::number(dpi);
+    auto it = cache.find(key);
+    if (it != cache.end())
+    {
+        return it.value();
+    }
+
+    if (cache.size() >= kMaxCachedNameLayouts)
+    {
+        cache.clear();
+    }
+
+    const QRectF cRect(0, 0, width, height);
+    QFont f = baseFont;
+    for (int sizeCandidate = 8; sizeCandidate > 1; sizeCandidate--)
+    {
+        f.setPointSize(sizeCandidate);
+        QFontMetricsF fm(f, pDevice);
+        const auto textRect = fm.boundingRect(cRect, Qt::AlignCenter | Qt::TextWrapAnywhere, objectName);
+
+        if (textRect.width() < cRect.width() &&
+            textRect.height() < cRect.height())
+        {
+            break;
+        }
+    }
+
+    ObjectNameLayout nameLayout;
+    nameLayout.mPointSize = f.pointSize();
+    nameLayout.mLayout = std::make_shared<QTextLayout>(objectName, f, pDevice);
+
+    QTextOption option(Qt::AlignHCenter);
+    option.setWrapMode(QTextOption::WrapAnywhere);
+    nameLayout.mLayout->setTextOption(option);
+
+    qreal textHeight = 0;
+    nameLayout.mLayout->beginLayout();
+    for (QTextLine line = nameLayout.mLayout->createLine(); line.isValid(); line = nameLayout.mLayout->createLine())
+    {
+        line.setLineWidth(width);
+        line.setPosition(QPointF(0, textHeight));
+        textHeight += line.height();
+    }
+    nameLayout.mLayout->endLayout();
+
+    nameLayout.mOffset = QPointF(0, (height - textHeight) / 2);
+
+    return cache.insert(key, nameLayout).value();
+}
+
+void DrawObjectName(QPainter* pPainter, qreal levelOfDetail, const std::string& objectName, int width, int height)
+{
+    const auto& nameLayout = GetObjectNameLayout(pPainter->font(), pPainter->device(), QString::fromStdString(objectName), width, height);
+
+    // Zoomed too far out to read it anyway
+    if (nameLayout.mPointSize * levelOfDetail >= kMinReadableTextHeight)
+    {
+        nameLayout.mLayout->draw(pPainter, nameLayout.mOffset);
+    }
+}
+
+ResizeableRectItem::ResizeableRectItem(QGraphicsView* pView, MapObject* pMapObject, ISyncPropertiesToTree& propSyncer, SnapSettings& snapSettings, IPointSnapper& snapper)
       : mView(pView), mMapObject(pMapObject), mPropSyncer(propSyncer), mSnapSettings(snapSettings), mPointSnapper(snapper)
 {
     SyncFromMapObject();
 
     Init();
     setZValue(3.0 + CalcZPos());
-
-    SetTransparency(this, transparency);
 }
 
 // TODO: Re-calc on new w/h
@@ -90,6 +178,15 @@ void ResizeableRectItem::mouseReleaseEvent( QGraphicsSceneMouseEvent* aEvent )
 
 void ResizeableRectItem::paint( QPainter* aPainter, const QStyleOptionGraphicsItem* aOption, QWidget* aWidget)
 {
+    // The batched layer draws it unless it's being edited, those empty paints aren't profiled
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene && pScene->BatchedRendering() && !isSelected() && !mHovered)
+    {
+        return;
+    }
+
+    PAINT_PROFILE_SCOPE(MapObject);
+
     QRectF cRect(0, 0, mWidth, mHeight);
 
     if ( isSelected() )
@@ -102,38 +199,23 @@ void ResizeableRectItem::paint( QPainter* aPainter, const QStyleOptionGraphicsIt
         aPainter->setPen( QPen( Qt::black, 2, Qt::SolidLine ) );
     }
     
-    if ( m_Pixmap.isNull() )
+    if ( mIconRect.isNull() )
     {
         aPainter->setBrush( Qt::darkGray );
     }
     else
     {
        // aPainter->setBrush( QBrush() );
-        aPainter->drawPixmap( cRect.x(), cRect.y(), cRect.width(), cRect.height(), m_Pixmap );
+        aPainter->drawPixmap( cRect, ObjectIconAtlas::Instance().Pixmap(), mIconRect );
     }
 
     // Draw the rect outline.
     aPainter->drawRect(cRect);
 
-    // Draw the object name on the rect if no image is provided
-    if (m_Pixmap.isNull())
+    // Draw the object name on the rect if no image is provided, text is skipped while the view is moving
+    if (mIconRect.isNull() && !(pScene && pScene->DraftRendering()))
     {
-        const auto objectName = mMapObject->mObjectStructureType.c_str();
-        for (int sizeCandidate = 8; sizeCandidate > 1; sizeCandidate--)
-        {
-            QFont f = aPainter->font();
-            f.setPointSize(sizeCandidate);
-            aPainter->setFont(f);
-            QFontMetricsF fm(f);
-            const auto textRect = fm.boundingRect(cRect, Qt::AlignCenter | Qt::TextWrapAnywhere, objectName);
-
-            if (textRect.width() < cRect.width() &&
-                textRect.height() < cRect.height())
-            {
-                break;
-            }
-        }
-        aPainter->drawText(cRect, Qt::AlignCenter | Qt::TextWrapAnywhere, objectName);
+        DrawObjectName(aPainter, aOption->levelOfDetailFromTransform(aPainter->worldTransform()), mMapObject->mObjectStructureType, mWidth, mHeight);
     }
 }
 
@@ -143,7 +225,13 @@ QRectF ResizeableRectItem::boundingRect() const
     return QRectF(0 - penWidth / 2, 0 - penWidth / 2, mWidth + penWidth, mHeight + penWidth);
 }
 
-void ResizeableRectItem::hoverMoveEvent( QGraphicsSceneHoverEvent* aEvent )
+void ResizeableRectItem::HoverEnter()
+{
+    mHovered = true;
+    update();
+}
+
+void ResizeableRectItem::HoverMove( const QPointF& itemPos )
 { 
     //qDebug("Resize mode = %d", m_ResizeMode);
     if (!(flags() & QGraphicsItem::ItemIsSelectable) || !QGraphicsItem::isSelected())
@@ -152,7 +240,7 @@ void ResizeableRectItem::hoverMoveEvent( QGraphicsSceneHoverEvent* aEvent )
         return;
     }
 
-    const eResize resizeLocation = getResizeLocation( aEvent->pos(), boundingRect() );
+    const eResize resizeLocation = getResizeLocation( itemPos, boundingRect() );
     switch ( resizeLocation )
     {
     case eResize_None:
@@ -193,10 +281,11 @@ void ResizeableRectItem::hoverMoveEvent( QGraphicsSceneHoverEvent* aEvent )
     }
 }
 
-void ResizeableRectItem::hoverLeaveEvent( QGraphicsSceneHoverEvent* aEvent )
+void ResizeableRectItem::HoverLeave()
 {
+    mHovered = false;
+    update();
     SetViewCursor( Qt::ArrowCursor );
-    QGraphicsItem::hoverLeaveEvent( aEvent );
 }
 
 QVariant ResizeableRectItem::itemChange( GraphicsItemChange aChange, const QVariant& aValue )
@@ -205,6 +294,11 @@ QVariant ResizeableRectItem::itemChange( GraphicsItemChange aChange, const QVari
     {
         PosOrRectChanged();
     }
+    else if ( aChange == ItemSceneChange || aChange == ItemSceneHasChanged || aChange == ItemSelectedHasChanged )
+    {
+        // Leaving the scene, joining it or being selected all change what the batched layer draws
+        InvalidateBatchedLayers();
+    }
     return QGraphicsItem::itemChange( aChange, aValue );
 }
 
@@ -212,11 +306,6 @@ void ResizeableRectItem::Init()
 {
     m_ResizeMode = eResize_None;
 
-    setAcceptHoverEvents( true );
-
-    // Change mouse cursor on hover so its easy to see when you can click to move the item
-    SetViewCursor( Qt::PointingHandCursor );
-
     // Allow select and move.
     setFlags( ItemSendsScenePositionChanges | ItemSendsGeometryChanges | ItemIsMovable | ItemIsSelectable );
 
@@ -356,7 +445,7 @@ void ResizeableRectItem::onResize( QPointF aPos )
 
 void ResizeableRectItem::SetViewCursor(Qt::CursorShape cursor)
 {
-    mView->setCursor(cursor);
+    static_cast<EditorGraphicsView*>(mView)->SetCursorShape(cursor);
 }
 
 QRectF ResizeableRectItem::CurrentRect() const
@@ -381,6 +470,7 @@ void ResizeableRectItem::SyncFromMapObject()
     setWidth(mMapObject->Width());
     setHeight(mMapObject->Height());
     UpdateIcon();
+    GeometryChanged();
 }
 
 void ResizeableRectItem::SyncToMapObject()
@@ -393,16 +483,53 @@ void ResizeableRectItem::SyncToMapObject()
 }
 
 void ResizeableRectItem::PosOrRectChanged()
+{
+    GeometryChanged();
+
+    // A drag can move hundreds of items per mouse move, the scene syncs them all once per frame instead
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene && pScene->Dragging())
+    {
+        pScene->QueueModelSync(this);
+        return;
+    }
+    SyncModelAndPropertyTree();
+}
+
+void ResizeableRectItem::SyncModel()
 {
     SyncToMapObject();
+}
+
+void ResizeableRectItem::SyncModelAndPropertyTree()
+{
+    SyncModel();
 
     // Update the property tree view
     mPropSyncer.Sync(this);
 }
 
+void ResizeableRectItem::GeometryChanged()
+{
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene)
+    {
+        pScene->ItemGeometryChanged(this);
+    }
+}
+
+void ResizeableRectItem::InvalidateBatchedLayers()
+{
+    auto pScene = static_cast<EditorGraphicsScene*>(scene());
+    if (pScene)
+    {
+        pScene->InvalidateBatchedItem(this);
+    }
+}
+
 void ResizeableRectItem::UpdateIcon()
 {
-    QString images_path = ":/object_images/rsc/object_images/";
+    QString icon_dir;
     QString object_name = mMapObject->mObjectStructureType.c_str();
     
     if( object_name == "BirdPortal" )
@@ -421,7 +548,7 @@ void ResizeableRectItem::UpdateIcon()
     }
     else if( object_name == "Drill" )
     {
-        images_path = images_path + object_name + "/";
+        icon_dir = icon_dir + object_name + "/";
         object_name += "_";
         
         if( mWidth > 25 )
@@ -435,7 +562,7 @@ void ResizeableRectItem::UpdateIcon()
     }
     else if( object_name == "Edge" || object_name == "Hoist" )
     {
-        images_path = images_path + object_name + "/";
+        icon_dir = icon_dir + object_name + "/";
         
         if( PropertyByName( "Grab Direction", mMapObject->mProperties ))
         {
@@ -451,14 +578,14 @@ void ResizeableRectItem::UpdateIcon()
     }
     else if( object_name == "MotionDetector" )
     {
-        images_path = images_path + object_name + "/";
+        icon_dir = icon_dir + object_name + "/";
         object_name = QString::number(std::max(std::min((mWidth / 26), 10), 0));
     }
     else if( object_name == "Mudokon" )
     {
         if( PropertyByName( "Emotion", mMapObject->mProperties ))
         {
-            images_path = images_path + object_name + "/";
+            icon_dir = icon_dir + object_name + "/";
             object_name = "Mud";
             
             if( PropertyByName( "Emotion", mMapObject->mProperties )->mEnumValue == "Angry" )
@@ -499,9 +626,5 @@ void ResizeableRectItem::UpdateIcon()
         }
     }
     
-    if ( !QPixmapCache::find(images_path + object_name + ".png", &m_Pixmap ) )
-    {
-        m_Pixmap = QPixmap(images_path + object_name + ".png");
-        QPixmapCache::insert(images_path + object_name + ".png", m_Pixmap );
-    }
+    mIconRect = ObjectIconAtlas::Instance().IconRect(icon_dir + object_name);
 }
\ No newline at end of file
@@ -9,15 +9,21 @@ class ISyncPropertiesToTree;
 class SnapSettings;
 class IPointSnapper;
 
+// Draws the name of an object without an icon in the box (0, 0, width, height), using the
+// biggest font that fits. Nothing is drawn when the level of detail makes it too small to read.
+void DrawObjectName(QPainter* pPainter, qreal levelOfDetail, const std::string& objectName, int width, int height);
+
 class ResizeableRectItem final : public IGraphicsItem, public QGraphicsItem
 {
 public:
-    ResizeableRectItem(QGraphicsView* pView, MapObject* pMapObject, ISyncPropertiesToTree& propSyncer, int transparency, SnapSettings& snapSettings, IPointSnapper& snapper);
+    ResizeableRectItem(QGraphicsView* pView, MapObject* pMapObject, ISyncPropertiesToTree& propSyncer, SnapSettings& snapSettings, IPointSnapper& snapper);
     enum { Type = UserType + 1 };
     int type() const override { return Type; }
     QRectF CurrentRect() const;
     void SetRect(const QRectF& rect);
     MapObject* GetMapObject() const { return mMapObject; }
+    // Where the icon is in the ObjectIconAtlas, null if the object has none
+    const QRect& IconRect() const { return mIconRect; }
  
     void SyncInternalObject() override
     {
@@ -29,13 +35,22 @@ public:
         return mMapObject->mProperties;
     }
 
+    // Writes the position and size to the map object and refreshes the property tree
+    void SyncModelAndPropertyTree();
+
+    // Only the map object, for when the property tree is refreshed once for many items
+    void SyncModel();
+
+    // Called by the scene, which finds the hovered item through its spatial index instead of Qt's hover events
+    void HoverEnter();
+    void HoverMove(const QPointF& itemPos);
+    void HoverLeave();
+
 private:  // From QGraphicsItem
     void mousePressEvent(QGraphicsSceneMouseEvent* aEvent) override;
     void mouseMoveEvent(QGraphicsSceneMouseEvent* aEvent) override;
     void mouseReleaseEvent(QGraphicsSceneMouseEvent* aEvent) override;
     void paint(QPainter* aPainter, const QStyleOptionGraphicsItem* aOption, QWidget* aWidget = nullptr) override;
-    void hoverMoveEvent(QGraphicsSceneHoverEvent* aEvent) override;
-    void hoverLeaveEvent(QGraphicsSceneHoverEvent* aEvent) override;
     QVariant itemChange(GraphicsItemChange aChange, const QVariant& aValue) override;
     QRectF boundingRect() const override;
 private:
@@ -80,16 +95,19 @@ private:
     }
 
     void SyncToMapObject();
+    void GeometryChanged();
+    void InvalidateBatchedLayers();
 
 private:
     eResize m_ResizeMode = eResize_None;
     static const quint32 kMinRectSize;
-    QPixmap m_Pixmap;
+    QRect mIconRect;
     QGraphicsView* mView = nullptr;
     MapObject* mMapObject = nullptr;
     ISyncPropertiesToTree& mPropSyncer;
     int mWidth = 0;
     int mHeight = 0;
+    bool mHovered = false;
 
     SnapSettings& mSnapSettings;
     IPointSnapper& mPointSnapper;
@@ -0,0 +1,526 @@
+#include "RoundTripTest.hpp"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <set>
+#include <iostream>
+#include <optional>
+#include <vector>
+#include "Model.hpp"
+#include "Exporter.hpp"
+#include "ReliveApiWrapper.hpp"
+#include "ProcessMemory.hpp"
+
+static const char* kStageNames[] =
+{
+    "lvl_to_json",
+    "json_to_model",
+    "model_to_json",
+    "json_to_lvl",
+    "lvl_to_json_again",
+};
+
+const int kStageCount = static_cast<int>(sizeof(kStageNames) / sizeof(kStageNames[0]));
+
+struct StageResult final
+{
+    qint64 mElapsedMs = 0;
+
+    // The process wide peak once the stage is done, not the stage's own. It never goes down, so
+    // a stage only shows up here when it pushes the peak above every path and stage before it.
+    qint64 mProcessPeakMemoryKb = 0;
+};
+
+struct RoundTripResult final
+{
+    QString mName;
+    bool mOk = false;
+    QString mError;
+    StageResult mStages[kStageCount];
+};
+
+// Loading through the model and saving again gives json with a fixed key order and
+// formatting, so two json strings with the same structure give the same canonical string
+static std::string CanonicalJson(const std::string& json)
+{
+    Model model;
+    model.LoadJsonFromString(json);
+    return model.ToJson();
+}
+
+static int FirstDifferentLine(const std::string& a, const std::string& b)
+{
+    int line = 1;
+    const size_t len = std::min(a.size(), b.size());
+    for (size_t i = 0; i < len; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return line;
+        }
+
+        if (a[i] == '\n')
+        {
+            line++;
+        }
+    }
+    return line;
+}
+
+static QString JsonValueText(const QJsonValue& value)
+{
+    if (value.isObject() || value.isArray())
+    {
+        return value.isObject() ? "{...}" : "[...]";
+    }
+    return QString::fromUtf8(QJsonDocument(QJsonArray{ value }).toJson(QJsonDocument::Compact)).mid(1).chopped(1);
+}
+
+// Compares the structure and values of two json documents ignoring key order and formatting,
+// returns the path of the first difference and what differs or nothing when they are the same
+static std::optional<QString> FirstJsonDifference(const QJsonValue& expected, const QJsonValue& actual, const QString& path)
+{
+    if (expected.type() != actual.type())
+    {
+        return path + ": " + JsonValueText(expected) + " became " + JsonValueText(actual);
+    }
+
+    if (expected.isObject())
+    {
+        const QJsonObject expectedObject = expected.toObject();
+        const QJsonObject actualObject = actual.toObject();
+
+        // Keys are visited in order so the reported difference is the same every run
+        std::set<QString> keys;
+        for (const QString& key : expectedObject.keys())
+        {
+            keys.insert(key);
+        }
+        for (const QString& key : actualObject.keys())
+        {
+            keys.insert(key);
+        }
+
+        for (const QString& key : keys)
+        {
+            const QString keyPath = path + "." + key;
+            if (!actualObject.contains(key))
+            {
+                return keyPath + ": missing";
+            }
+
+            if (!expectedObject.contains(key))
+            {
+                return keyPath + ": added";
+            }
+
+            const std::optional<QString> difference = FirstJsonDifference(expectedObject.value(key), actualObject.value(key), keyPath);
+            if (difference)
+            {
+                return difference;
+            }
+        }
+        return {};
+    }
+
+    if (expected.isArray())
+    {
+        const QJsonArray expectedArray = expected.toArray();
+        const QJsonArray actualArray = actual.toArray();
+        const int commonSize = std::min(expectedArray.size(), actualArray.size());
+        for (int i = 0; i < commonSize; i++)
+        {
+            const std::optional<QString> difference = FirstJsonDifference(expectedArray[i], actualArray[i], path + "[" + QString::number(i) + "]");
+            if (difference)
+            {
+                return difference;
+            }
+        }
+
+        if (expectedArray.size() != actualArray.size())
+        {
+            return path + ": " + QString::number(expectedArray.size()) + " entries became " + QString::number(actualArray.size());
+        }
+        return {};
+    }
+
+    if (expected != actual)
+    {
+        return path + ": " + JsonValueText(expected) + " became " + JsonValueText(actual);
+    }
+    return {};
+}
+
+static std::optional<QString> FirstJsonDifference(const std::string& expectedJson, const std::string& actualJson)
+{
+    QJsonParseError expectedError;
+    QJsonParseError actualError;
+    const QJsonDocument expected = QJsonDocument::fromJson(QByteArray::fromStdString(expectedJson), &expectedError);
+    const QJsonDocument actual = QJsonDocument::fromJson(QByteArray::fromStdString(actualJson), &actualError);
+    if (expected.isNull() || actual.isNull())
+    {
+        return "failed to parse the json: " + (expected.isNull() ? expectedError.errorString() : actualError.errorString());
+    }
+
+    const QJsonValue expectedRoot = expected.isObject() ? QJsonValue(expected.object()) : QJsonValue(expected.array());
+    const QJsonValue actualRoot = actual.isObject() ? QJsonValue(actual.object()) : QJsonValue(actual.array());
+    return FirstJsonDifference(expectedRoot, actualRoot, "$");
+}
+
+static std::optional<std::string> ReadTextFile(const QString& fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+    {
+        return {};
+    }
+    return f.readAll().toStdString();
+}
+
+static bool WriteTextFile(const QString& fileName, const std::string& text)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+    return f.write(text.data(), static_cast<qint64>(text.size())) == static_cast<qint64>(text.size());
+}
+
+class StageTimer final
+{
+public:
+    explicit StageTimer(StageResult& result)
+        : mResult(result)
+    {
+        mTimer.start();
+    }
+
+    ~StageTimer()
+    {
+        mResult.mElapsedMs = mTimer.elapsed();
+        mResult.mProcessPeakMemoryKb = PeakProcessMemoryKb();
+    }
+
+private:
+    StageResult& mResult;
+    QElapsedTimer mTimer;
+};
+
+static bool RoundTripPath(const QString& lvlFile, int pathId, const QString& workDir, RoundTripResult& result)
+{
+    EditorFileIO fileIo;
+    const QString baseName = QDir(workDir).filePath(result.mName);
+    const QString exportedJsonFile = baseName + ".json";
+    const QString savedJsonFile = baseName + "_saved.json";
+    const QString lvlCopyFile = baseName + ".lvl";
+    const QString reExportedJsonFile = baseName + "_reexported.json";
+
+    auto fnOnError = [&](const QString err)
+    {
+        result.mError = err;
+    };
+
+    ReliveAPI::Context exportContext;
+    {
+        StageTimer timer(result.mStages[0]);
+        if (!ExecApiCall([&]()
+            {
+                ReliveAPI::ExportPathBinaryToJson(fileIo, exportedJsonFile.toStdString(), lvlFile.toStdString(), pathId, exportContext);
+                return true;
+            }, fnOnError))
+        {
+            result.mError = "lvl to json: " + result.mError;
+            return false;
+        }
+    }
+
+    const std::optional<std::string> exportedJson = ReadTextFile(exportedJsonFile);
+    if (!exportedJson)
+    {
+        result.mError = "Failed to read " + exportedJsonFile;
+        return false;
+    }
+
+    try
+    {
+        auto model = std::make_unique<Model>();
+        {
+            StageTimer timer(result.mStages[1]);
+            model->LoadJsonFromString(*exportedJson);
+        }
+
+        std::string savedJson;
+        {
+            StageTimer timer(result.mStages[2]);
+            savedJson = model->ToJson();
+        }
+        model.reset();
+
+        // Everything the lvl export wrote has to survive the model, this catches anything it drops or rewrites
+        const std::optional<QString> modelDifference = FirstJsonDifference(*exportedJson, savedJson);
+        if (modelDifference)
+        {
+            result.mError = "Model json differs from the lvl export at " + *modelDifference;
+            return false;
+        }
+
+        // Saving what was just loaded must not change anything
+        const std::string canonicalSaved = CanonicalJson(savedJson);
+        if (canonicalSaved != savedJson)
+        {
+            result.mError = "Model json isn't stable after a load/save, first difference at line " + QString::number(FirstDifferentLine(canonicalSaved, savedJson));
+            return false;
+        }
+
+        if (!WriteTextFile(savedJsonFile, savedJson))
+        {
+            result.mError = "Failed to write " + savedJsonFile;
+            return false;
+        }
+
+        // Export into a copy so the source LVL is never modified
+        QFile::remove(lvlCopyFile);
+        if (!QFile::copy(lvlFile, lvlCopyFile))
+        {
+            result.mError = "Failed to copy " + lvlFile + " to " + lvlCopyFile;
+            return false;
+        }
+
+        {
+            StageTimer timer(result.mStages[3]);
+            ReliveAPI::Context importContext;
+            std::set<std::string> resourceSources = { lvlFile.toStdString() };
+            if (!exportJsonToLvl(savedJsonFile, lvlCopyFile, "relive_roundtrip", fnOnError, resourceSources, importContext))
+            {
+                result.mError = "json to lvl: " + result.mError;
+                return false;
+            }
+        }
+
+        ReliveAPI::Context reExportContext;
+        {
+            StageTimer timer(result.mStages[4]);
+            if (!ExecApiCall([&]()
+                {
+                    ReliveAPI::ExportPathBinaryToJson(fileIo, reExportedJsonFile.toStdString(), lvlCopyFile.toStdString(), pathId, reExportContext);
+                    return true;
+                }, fnOnError))
+            {
+                result.mError = "lvl to json again: " + result.mError;
+                return false;
+            }
+        }
+
+        const std::optional<std::string> reExportedJson = ReadTextFile(reExportedJsonFile);
+        if (!reExportedJson)
+        {
+            result.mError = "Failed to read " + reExportedJsonFile;
+            return false;
+        }
+
+        const std::optional<QString> lvlDifference = FirstJsonDifference(*exportedJson, *reExportedJson);
+        if (lvlDifference)
+        {
+            result.mError = "Json after the lvl round trip differs at " + *lvlDifference;
+            return false;
+        }
+    }
+    catch (const ModelException& e)
+    {
+        result.mError = "Model exception: " + QString::fromStdString(e.what());
+        return false;
+    }
+
+    // Only keep the files around when something went wrong so they can be diffed
+    QFile::remove(exportedJsonFile);
+    QFile::remove(savedJsonFile);
+    QFile::remove(lvlCopyFile);
+    QFile::remove(reExportedJsonFile);
+    return true;
+}
+
+// Name -> elapsed ms per stage
+using TimingBaseline = QMap<QString, std::vector<qint64>>;
+
+static TimingBaseline ReadBaseline(const QString& csvFile)
+{
+    TimingBaseline baseline;
+    QFile f(csvFile);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return baseline;
+    }
+
+    QTextStream stream(&f);
+    stream.readLine(); // Skip the header
+    while (!stream.atEnd())
+    {
+        const QStringList columns = stream.readLine().split(',');
+        if (columns.size() != 2 + (kStageCount * 2))
+        {
+            continue;
+        }
+
+        std::vector<qint64> elapsed;
+        for (int i = 0; i < kStageCount; i++)
+        {
+            elapsed.push_back(columns[2 + (i * 2)].toLongLong());
+        }
+        baseline[columns[0]] = elapsed;
+    }
+    return baseline;
+}
+
+static bool WriteTimings(const QString& csvFile, const std::vector<RoundTripResult>& results)
+{
+    QFile f(csvFile);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        return false;
+    }
+
+    QTextStream stream(&f);
+    stream << "path,ok";
+    for (const char* stageName : kStageNames)
+    {
+        stream << "," << stageName << "_ms," << stageName << "_process_peak_kb";
+    }
+    stream << "\n";
+
+    for (const auto& result : results)
+    {
+        stream << result.mName << "," << (result.mOk ? 1 : 0);
+        for (const auto& stage : result.mStages)
+        {
+            stream << "," << stage.mElapsedMs << "," << stage.mProcessPeakMemoryKb;
+        }
+        stream << "\n";
+    }
+    return true;
+}
+
+int RoundTripCommandLine(const QStringList& args)
+{
+    if (args.size() < 2)
+    {
+        std::cerr << "Incorrect usage of the --roundtrip option, should be --roundtrip lvl1 [lvl2 ...] workDir" << std::endl;
+        return 1;
+    }
+
+    const QString workDir = args.last();
+    if (!QDir().mkpath(workDir))
+    {
+        std::cerr << "Failed to create work directory " << workDir.toStdString() << std::endl;
+        return 1;
+    }
+
+    int runResult = 0;
+    std::vector<RoundTripResult> results;
+
+    // Paths are done one at a time so the timings and memory use aren't skewed by each other
+    EditorFileIO fileIo;
+    for (int i = 0; i < args.size() - 1; i++)
+    {
+        const QString lvlFile = args.at(i);
+        ReliveAPI::EnumeratePathsResult ret;
+        if (!ExecApiCall([&]()
+            {
+                ret = ReliveAPI::EnumeratePaths(fileIo, lvlFile.toStdString());
+                return true;
+            },
+            [&](const QString err)
+            {
+                std::cerr << "Failed to enumerate the paths in " << lvlFile.toStdString() << ". " << err.toStdString() << std::endl;
+            }))
+        {
+            runResult = 1;
+            continue;
+        }
+
+        for (const int pathId : ret.paths)
+        {
+            RoundTripResult result;
+            result.mName = QFileInfo(lvlFile).completeBaseName() + "_" + QString::number(pathId);
+            result.mOk = RoundTripPath(lvlFile, pathId, workDir, result);
+
+            if (result.mOk)
+            {
+                std::cout << "PASS " << result.mName.toStdString() << std::endl;
+            }
+            else
+            {
+                std::cout << "FAIL " << result.mName.toStdString() << " " << result.mError.toStdString() << std::endl;
+                runResult = 1;
+            }
+            results.push_back(result);
+        }
+    }
+
+    const QString baselineFile = QDir(workDir).filePath("roundtrip_baseline.csv");
+    const TimingBaseline baseline = ReadBaseline(baselineFile);
+
+    // Paths added or missing since the baseline would show up as a time change, so the deltas
+    // only cover the paths in both runs
+    std::vector<qint64> totals(kStageCount, 0);
+    std::vector<qint64> comparedTotals(kStageCount, 0);
+    std::vector<qint64> baselineTotals(kStageCount, 0);
+    int comparedCount = 0;
+    for (const auto& result : results)
+    {
+        auto it = baseline.find(result.mName);
+        for (int i = 0; i < kStageCount; i++)
+        {
+            totals[i] += result.mStages[i].mElapsedMs;
+            if (it != baseline.end())
+            {
+                comparedTotals[i] += result.mStages[i].mElapsedMs;
+                baselineTotals[i] += it.value()[i];
+            }
+        }
+
+        if (it != baseline.end())
+        {
+            comparedCount++;
+        }
+    }
+
+    std::cout << std::endl << "Stage totals for " << results.size() << " paths:" << std::endl;
+    for (int i = 0; i < kStageCount; i++)
+    {
+        std::cout << "  " << kStageNames[i] << ": " << totals[i] << "ms";
+        if (comparedCount > 0)
+        {
+            const qint64 delta = comparedTotals[i] - baselineTotals[i];
+            std::cout << " (" << (delta >= 0 ? "+" : "") << delta << "ms vs baseline)";
+        }
+        std::cout << std::endl;
+    }
+
+    if (!baseline.isEmpty())
+    {
+        std::cout << "  baseline deltas are over the " << comparedCount << " of " << results.size() << " paths that are also in the baseline" << std::endl;
+    }
+    std::cout << "  process peak memory: " << PeakProcessMemoryKb() << "KB" << std::endl;
+
+    if (!WriteTimings(QDir(workDir).filePath("roundtrip_timings.csv"), results))
+    {
+        std::cerr << "Failed to write the timings csv" << std::endl;
+        runResult = 1;
+    }
+
+    // The first run becomes the baseline for the following ones
+    if (baseline.isEmpty() && !WriteTimings(baselineFile, results))
+    {
+        std::cerr << "Failed to write the baseline csv" << std::endl;
+        runResult = 1;
+    }
+
+    return runResult;
+}
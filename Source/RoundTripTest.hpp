@@ -0,0 +1,11 @@
+#pragma once
+
+#include <QStringList>
+
+// Handles --roundtrip lvl1 [lvl2 ...] workDir, every path in every LVL goes through
+// lvl -> json -> Model -> json -> lvl -> json and each step is checked to give the same
+// structure as the last. Per stage timings are written to workDir/roundtrip_timings.csv and
+// compared against workDir/roundtrip_baseline.csv when it exists. Next to each timing is the
+// process peak memory once that stage finished, which is cumulative over the whole run rather
+// than the peak of the stage itself. Returns the process exit code.
+int RoundTripCommandLine(const QStringList& args);
@@ -3,9 +3,8 @@
 #include "ReliveApiWrapper.hpp"
 #include <QMessageBox>
 
-inline void ShowContext(const ReliveAPI::Context& context)
+inline QString ContextToString(const ReliveAPI::Context& context)
 {
-    // TODO: Should be a dialog showing the source file of each warning
     QString fatMessage;
     for (const auto& remapped : context.RemappedEnumValues())
     {
@@ -49,6 +48,11 @@ inline void ShowContext(const ReliveAPI::Context& context)
         fatMessage += tmp;
     }
 
-    QMessageBox::warning(nullptr, "Context warnings", fatMessage);
+    return fatMessage;
+}
 
+inline void ShowContext(const ReliveAPI::Context& context)
+{
+    // TODO: Should be a dialog showing the source file of each warning
+    QMessageBox::warning(nullptr, "Context warnings", ContextToString(context));
 }
@@ -0,0 +1,175 @@
+#include "SpatialIndex.hpp"
+#include <QGraphicsItem>
+#include <algorithm>
+#include <cmath>
+
+// Inclusive on all edges so zero width/height rects (points, vertical lines) still match
+static bool Overlaps(const QRectF& a, const QRectF& b)
+{
+    return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+SpatialIndex::SpatialIndex(int cellSize)
+    : mCellSize(cellSize)
+{
+
+}
+
+void SpatialIndex::Update(QGraphicsItem* pItem, const QRectF& sceneRect)
+{
+    const QRectF rect = sceneRect.normalized();
+    const QRect cells = CellRange(rect);
+
+    auto it = mEntries.find(pItem);
+    if (it != mEntries.end())
+    {
+        it->mRect = rect;
+
+        // Most moves and resizes stay within the same cells
+        if (it->mCells == cells)
+        {
+            return;
+        }
+
+        RemoveFromCells(pItem, it->mCells);
+        it->mCells = cells;
+    }
+    else
+    {
+        mEntries.insert(pItem, { rect, cells });
+    }
+
+    AddToCells(pItem, cells);
+}
+
+void SpatialIndex::Remove(QGraphicsItem* pItem)
+{
+    auto it = mEntries.find(pItem);
+    if (it == mEntries.end())
+    {
+        return;
+    }
+
+    RemoveFromCells(pItem, it->mCells);
+    mEntries.erase(it);
+}
+
+void SpatialIndex::Clear()
+{
+    mCells.clear();
+    mEntries.clear();
+}
+
+QList<QGraphicsItem*> SpatialIndex::ItemsAt(const QPointF& scenePos) const
+{
+    QList<QGraphicsItem*> found;
+
+    const int cellX = static_cast<int>(std::floor(scenePos.x() / mCellSize));
+    const int cellY = static_cast<int>(std::floor(scenePos.y() / mCellSize));
+    auto cellIt = mCells.constFind(CellKey(cellX, cellY));
+    if (cellIt == mCells.constEnd())
+    {
+        return found;
+    }
+
+    const QRectF point(scenePos, QSizeF(0, 0));
+    for (QGraphicsItem* pItem : *cellIt)
+    {
+        if (Overlaps(mEntries.value(pItem).mRect, point))
+        {
+            found.append(pItem);
+        }
+    }
+    return found;
+}
+
+QList<QGraphicsItem*> SpatialIndex::ItemsIn(const QRectF& sceneRect) const
+{
+    QList<QGraphicsItem*> found;
+
+    const QRectF rect = sceneRect.normalized();
+    const QRect cells = CellRange(rect);
+    for (int y = cells.top(); y <= cells.bottom(); y++)
+    {
+        for (int x = cells.left(); x <= cells.right(); x++)
+        {
+            auto cellIt = mCells.constFind(CellKey(x, y));
+            if (cellIt == mCells.constEnd())
+            {
+                continue;
+            }
+
+            for (QGraphicsItem* pItem : *cellIt)
+            {
+                const Entry entry = mEntries.value(pItem);
+
+                // An item that spans several cells is only reported from the first cell it shares with
+                // the query, that way no set is needed to drop the duplicates
+                if (x != std::max(entry.mCells.left(), cells.left()) || y != std::max(entry.mCells.top(), cells.top()))
+                {
+                    continue;
+                }
+
+                if (Overlaps(entry.mRect, rect))
+                {
+                    found.append(pItem);
+                }
+            }
+        }
+    }
+    return found;
+}
+
+QRect SpatialIndex::CellRange(const QRectF& rect) const
+{
+    const int left = static_cast<int>(std::floor(rect.left() / mCellSize));
+    const int top = static_cast<int>(std::floor(rect.top() / mCellSize));
+    const int right = static_cast<int>(std::floor(rect.right() / mCellSize));
+    const int bottom = static_cast<int>(std::floor(rect.bottom() / mCellSize));
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+quint64 SpatialIndex::CellKey(int x, int y)
+{
+    return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+}
+
+void SpatialIndex::AddToCells(QGraphicsItem* pItem, const QRect& cells)
+{
+    for (int y = cells.top(); y <= cells.bottom(); y++)
+    {
+        for (int x = cells.left(); x <= cells.right(); x++)
+        {
+            mCells[CellKey(x, y)].push_back(pItem);
+        }
+    }
+}
+
+void SpatialIndex::RemoveFromCells(QGraphicsItem* pItem, const QRect& cells)
+{
+    for (int y = cells.top(); y <= cells.bottom(); y++)
+    {
+        for (int x = cells.left(); x <= cells.right(); x++)
+        {
+            auto cellIt = mCells.find(CellKey(x, y));
+            if (cellIt == mCells.end())
+            {
+                continue;
+            }
+
+            // Order within a cell doesn't matter so swap with the back instead of shifting everything down
+            std::vector<QGraphicsItem*>& cellItems = *cellIt;
+            auto itemIt = std::find(cellItems.begin(), cellItems.end(), pItem);
+            if (itemIt != cellItems.end())
+            {
+                *itemIt = cellItems.back();
+                cellItems.pop_back();
+            }
+
+            if (cellItems.empty())
+            {
+                mCells.erase(cellIt);
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QRect>
+#include <QRectF>
+#include <vector>
+
+class QGraphicsItem;
+
+// Uniform grid over the scene that buckets the collisions and map objects by the cells their
+// bounds touch. Picks and region queries only look at the items in the cells they cover, so
+// they cost the size of the queried area rather than the size of the path.
+class SpatialIndex final
+{
+public:
+    explicit SpatialIndex(int cellSize = 256);
+
+    // Adds the item or moves it to the cells covered by its new scene bounds
+    void Update(QGraphicsItem* pItem, const QRectF& sceneRect);
+    void Remove(QGraphicsItem* pItem);
+    void Clear();
+
+    bool Contains(QGraphicsItem* pItem) const
+    {
+        return mEntries.contains(pItem);
+    }
+
+    // The bounds the item was last added or moved with, a null rect if it isn't in the index
+    QRectF Bounds(QGraphicsItem* pItem) const
+    {
+        auto it = mEntries.constFind(pItem);
+        return it != mEntries.constEnd() ? it->mRect : QRectF();
+    }
+
+    int Count() const
+    {
+        return mEntries.count();
+    }
+
+    // Every item whose bounds contain the point
+    QList<QGraphicsItem*> ItemsAt(const QPointF& scenePos) const;
+
+    // Every item whose bounds intersect the rect, each item only appears once
+    QList<QGraphicsItem*> ItemsIn(const QRectF& sceneRect) const;
+
+private:
+    struct Entry final
+    {
+        QRectF mRect;
+        QRect mCells;
+    };
+
+    QRect CellRange(const QRectF& rect) const;
+    static quint64 CellKey(int x, int y);
+    void AddToCells(QGraphicsItem* pItem, const QRect& cells);
+    void RemoveFromCells(QGraphicsItem* pItem, const QRect& cells);
+
+    int mCellSize;
+    QHash<quint64, std::vector<QGraphicsItem*>> mCells;
+    QHash<QGraphicsItem*, Entry> mEntries;
+};
@@ -1,16 +1,17 @@
 #pragma once
 
 #include <QUndoCommand>
-#include <QLineEdit>
-#include <QUndoStack>
-#include "PropertyTreeItemBase.hpp"
+#include <QString>
+#include <string>
+#include <vector>
 
 class PropertyTreeWidget;
 
 class ChangeStringPropertyCommand : public QUndoCommand
 {
 public:
-    ChangeStringPropertyCommand(PropertyTreeWidget* pTreeWidget, std::string* pProperty, QString propertyName, QString oldValue, QString newValue);
+    // One old value per property, every property is set to the same new value
+    ChangeStringPropertyCommand(PropertyTreeWidget* pTreeWidget, std::vector<std::string*> properties, QString propertyName, std::vector<QString> oldValues, QString newValue);
 
     void undo() override;
 
@@ -18,52 +19,7 @@ public:
 
 private:
     PropertyTreeWidget* mTreeWidget = nullptr;
-    std::string* mProperty = nullptr;
-    QString mOldValue;
+    std::vector<std::string*> mProperties;
+    std::vector<QString> mOldValues;
     QString mNewValue;
 };
-
-class ReadOnlyStringProperty : public PropertyTreeItemBase
-{
-public:
-    ReadOnlyStringProperty(QTreeWidgetItem* pParent, QString propertyName, int* pProperty);
-
-    virtual QWidget* CreateEditorWidget(PropertyTreeWidget* ) override
-    {
-        return nullptr;
-    }
-
-    void Refresh() override
-    {
-        setText(1, QString::number(*mProperty));
-    }
-
-    const void* GetPropertyLookUpKey() const override
-    {
-        return mProperty;
-    }
-
-private:
-    int* mProperty = nullptr;
-};
-
-class StringProperty : public QObject, public PropertyTreeItemBase
-{
-    Q_OBJECT
-public:
-    StringProperty(QUndoStack& undoStack, QTreeWidgetItem* pParent, QString propertyName, std::string* pProperty);
-
-    virtual QWidget* CreateEditorWidget(PropertyTreeWidget* pParent) override;
-
-    virtual void Refresh() override;
-
-    const void* GetPropertyLookUpKey() const override
-    {
-        return mProperty;
-    }
-
-private:
-    std::string* mProperty = nullptr;
-    QString mPrevValue;
-    QUndoStack& mUndoStack;
-};
@@ -7,10 +7,13 @@
 #include <functional>
 #include <QtCore/qcommandlineparser.h>
 #include "ReliveApiWrapper.hpp"
+#include "ShowContext.hpp"
+#include "PathExtractor.hpp"
+#include "RoundTripTest.hpp"
 
 void DoMapSizeTests();
 
-static int exportJsonToLvlCommandLine(const QStringList& args)
+static int exportJsonToLvlCommandLine(const QStringList& args, LvlExportMode mode)
 {
     if (args.size() != 2)
     {
@@ -27,20 +30,11 @@ static int exportJsonToLvlCommandLine(const QStringList& args)
         {
             std::cerr << "Exporting failed. " << text << std::endl;
             runResult = 1;
-        }, resourceSources, context);
+        }, resourceSources, context, mode);
 
     if (!context.Ok())
     {
-        for (const auto& remapped : context.RemappedEnumValues())
-        {
-            std::cout << "Enum value " << remapped.mEnumValueInJson << " remapped to " << remapped.mValueUsed << " for enum type " << remapped.mEnumTypeName << std::endl;
-        }
-
-        for (const auto& missingProperty : context.MissingJsonProperties())
-        {
-            std::cout << "Property " << missingProperty.mPropertyName << " was not found in type " << missingProperty.mStructureTypeName << std::endl;
-        }
-        // TODO: there are other context warnings to show
+        std::cout << ContextToString(context).toStdString();
     }
     return runResult;
 }
@@ -67,13 +61,32 @@ int main(int argc, char *argv[])
     QCommandLineOption exportJsonToLvlOption("export", QCoreApplication::translate("main", "Export the .json file to the .lvl file. Usage: --export source dest"));
     parser.addOption(exportJsonToLvlOption);
 
+    QCommandLineOption patchLvlOption("patch", QCoreApplication::translate("main", "Used with --export, only write the changed parts of the .lvl file instead of replacing it."));
+    parser.addOption(patchLvlOption);
+
+    QCommandLineOption extractLvlToJsonOption("extract", QCoreApplication::translate("main", "Extract every path in the .lvl files to .json files. Usage: --extract lvl1 [lvl2 ...] outputDir"));
+    parser.addOption(extractLvlToJsonOption);
+
+    QCommandLineOption roundTripOption("roundtrip", QCoreApplication::translate("main", "Round trip every path in the .lvl files through json and back, checking nothing changes and timing each stage. Usage: --roundtrip lvl1 [lvl2 ...] workDir"));
+    parser.addOption(roundTripOption);
+
     parser.process(app);
 
     const QStringList args = parser.positionalArguments();
 
     if (parser.isSet(exportJsonToLvlOption))
     {
-        return exportJsonToLvlCommandLine(args);
+        return exportJsonToLvlCommandLine(args, parser.isSet(patchLvlOption) ? LvlExportMode::PatchInPlace : LvlExportMode::Replace);
+    }
+
+    if (parser.isSet(extractLvlToJsonOption))
+    {
+        return ExtractPathsCommandLine(args);
+    }
+
+    if (parser.isSet(roundTripOption))
+    {
+        return RoundTripCommandLine(args);
     }
 
     EditorMainWindow w;